@@ -0,0 +1,362 @@
+#ifndef LIBCHESS_BOARD_H
+#define LIBCHESS_BOARD_H
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <type_traits>
+
+#include "Bitboard.h"
+#include "CastlingRights.h"
+#include "Color.h"
+#include "Lookups.h"
+#include "Move.h"
+#include "Piece.h"
+#include "PieceType.h"
+#include "Square.h"
+#include "internal/MoveGen.h"
+#include "internal/StaticExchange.h"
+#include "internal/Zobrist.h"
+
+namespace libchess {
+
+class Position;
+
+/// A position without its history: the bitboards, the state of the current ply and its keys, in
+/// about a hundred bytes. It is trivially copyable, so a search thread can copy-make it, one copy
+/// per ply, instead of making and unmaking moves on a Position, and a memcpy snapshots it. The
+/// keys match Position::hash() and Position::pawn_hash() for the same position. Attacks, SEE,
+/// move validation, gives_check() and legal move generation, in full or split into captures and
+/// quiet moves, are shared with Position through internal/MoveGen.h and internal/StaticExchange.h.
+/// Only legal moves are generated: the pins a pseudo-legal generator would leave to a later
+/// legality check are resolved during generation. Repetitions need the history and are left to
+/// Position. Boards are taken from a Position with board().
+///
+/// There is no mailbox, so piece_type_on() tests the piece bitboards in turn; a 64-byte mailbox
+/// would make every copy half again as large, and make_move() only asks for the moving and
+/// captured pieces.
+class Board {
+   public:
+    using hash_type = std::uint64_t;
+
+    // An empty board; real positions come from Position::board()
+    Board() = default;
+
+    // Getters
+    Bitboard piece_type_bb(PieceType piece_type) const {
+        return piece_type_bb_[piece_type.value()];
+    }
+    Bitboard piece_type_bb(PieceType piece_type, Color color) const {
+        return piece_type_bb_[piece_type.value()] & color_bb(color);
+    }
+    Bitboard color_bb(Color color) const {
+        return color_bb_[color.value()];
+    }
+    Bitboard occupancy_bb() const {
+        return color_bb_[0] | color_bb_[1];
+    }
+    Color side_to_move() const {
+        return Color{side_to_move_};
+    }
+    CastlingRights castling_rights() const {
+        return CastlingRights{castling_rights_};
+    }
+    std::optional<Square> enpassant_square() const {
+        if (enpassant_square_ == NO_SQUARE) {
+            return std::nullopt;
+        }
+        return Square{enpassant_square_};
+    }
+    int halfmoves() const {
+        return halfmoves_;
+    }
+    int fullmoves() const {
+        return fullmoves_;
+    }
+    hash_type hash() const {
+        return hash_;
+    }
+    hash_type pawn_hash() const {
+        return pawn_hash_;
+    }
+    // Tests the piece bitboards in turn, see the note on the class
+    std::optional<PieceType> piece_type_on(Square square) const {
+        Bitboard square_bb{square};
+        if (!(occupancy_bb() & square_bb)) {
+            return std::nullopt;
+        }
+        for (PieceType pt : constants::PIECE_TYPES) {
+            if (piece_type_bb(pt) & square_bb) {
+                return pt;
+            }
+        }
+        return std::nullopt;
+    }
+    std::optional<Color> color_of(Square square) const {
+        Bitboard square_bb{square};
+        if (color_bb(constants::WHITE) & square_bb) {
+            return constants::WHITE;
+        }
+        if (color_bb(constants::BLACK) & square_bb) {
+            return constants::BLACK;
+        }
+        return std::nullopt;
+    }
+    std::optional<Piece> piece_on(Square square) const {
+        auto piece_type = piece_type_on(square);
+        if (!piece_type) {
+            return std::nullopt;
+        }
+        return Piece{*piece_type, *color_of(square)};
+    }
+    Square king_square(Color color) const {
+        return piece_type_bb(constants::KING, color).forward_bitscan();
+    }
+    Bitboard checkers() const {
+        return checkers_;
+    }
+    bool in_check() const {
+        return bool(checkers_);
+    }
+
+    // Attacks
+    Bitboard attackers_to(Square square, Bitboard occupancy) const {
+        return movegen::attackers_to(*this, square, occupancy);
+    }
+    Bitboard attackers_to(Square square) const {
+        return attackers_to(square, occupancy_bb());
+    }
+    Bitboard attackers_to(Square square, Color c) const {
+        return attackers_to(square, occupancy_bb()) & color_bb(c);
+    }
+    Bitboard attackers_to(Square square, Bitboard occupancy, Color c) const {
+        return attackers_to(square, occupancy) & color_bb(c);
+    }
+    Bitboard attacked_squares(Color c, Bitboard occupancy) const {
+        return movegen::attacked_squares(*this, c, occupancy);
+    }
+    Bitboard pinned_pieces_of(Color c) const {
+        return movegen::king_blockers(*this, c) & color_bb(c);
+    }
+    // Squares from which a piece of the side to move would check the opposing king
+    Bitboard check_squares(PieceType piece_type) const {
+        return movegen::check_squares(*this, piece_type, side_to_move());
+    }
+
+    // Move Integration
+    Move::Type move_type_of(Move move) const {
+        return movegen::move_type_of(*this, move);
+    }
+    bool is_capture_move(Move move) const {
+        return movegen::is_capture_move(move);
+    }
+    // Whether a pseudo-legal move of the side to move checks the opposing king
+    bool gives_check(Move move) const {
+        Color stm = side_to_move();
+        PieceType pt = *piece_type_on(move.from_square());
+        return movegen::gives_check(*this,
+                                    move,
+                                    check_squares(pt),
+                                    movegen::king_blockers(*this, !stm) & color_bb(stm));
+    }
+    // Validates an arbitrary move, such as a TT move or a killer, in constant time
+    bool is_legal_move(Move move) const {
+        return movegen::is_legal_move(*this, move, checkers_, pinned_pieces_of(side_to_move()));
+    }
+
+    void make_move(Move move) {
+        Color stm = side_to_move();
+        Square from_square = move.from_square();
+        Square to_square = move.to_square();
+        Move::Type move_type = move_type_of(move);
+        auto moving_pt = piece_type_on(from_square);
+
+        hash_ ^= zobrist::side_to_move_key();
+        clear_enpassant_square();
+        std::uint8_t next_castling_rights = castling_rights_ &
+                                            lookups::castling_spoilers(from_square) &
+                                            lookups::castling_spoilers(to_square);
+        if (next_castling_rights != castling_rights_) {
+            hash_ ^= zobrist::castling_rights_key(castling_rights()) ^
+                     zobrist::castling_rights_key(CastlingRights{next_castling_rights});
+            castling_rights_ = next_castling_rights;
+        }
+        ++halfmoves_;
+        if (stm == constants::BLACK) {
+            ++fullmoves_;
+        }
+        if (moving_pt == constants::PAWN) {
+            halfmoves_ = 0;
+        }
+
+        switch (move_type) {
+            case Move::Type::NORMAL:
+                move_piece(from_square, to_square, *moving_pt, stm);
+                break;
+            case Move::Type::CAPTURE:
+                remove_piece(to_square, *piece_type_on(to_square), !stm);
+                move_piece(from_square, to_square, *moving_pt, stm);
+                halfmoves_ = 0;
+                break;
+            case Move::Type::DOUBLE_PUSH: {
+                move_piece(from_square, to_square, constants::PAWN, stm);
+                Square ep_sq = lookups::pawn_shift(from_square, stm);
+                enpassant_square_ = std::uint8_t(ep_sq.value());
+                if (enpassant_capture_possible(ep_sq, !stm)) {
+                    hash_ ^= zobrist::enpassant_key(ep_sq);
+                }
+                break;
+            }
+            case Move::Type::ENPASSANT:
+                move_piece(from_square, to_square, constants::PAWN, stm);
+                remove_piece(lookups::pawn_shift(to_square, !stm), constants::PAWN, !stm);
+                break;
+            case Move::Type::CASTLING: {
+                move_piece(from_square, to_square, constants::KING, stm);
+                bool kingside = to_square > from_square;
+                move_piece(kingside ? from_square + 3 : from_square - 4,
+                           kingside ? from_square + 1 : from_square - 1,
+                           constants::ROOK,
+                           stm);
+                break;
+            }
+            case Move::Type::PROMOTION:
+                remove_piece(from_square, constants::PAWN, stm);
+                put_piece(to_square, *move.promotion_piece_type(), stm);
+                break;
+            case Move::Type::CAPTURE_PROMOTION:
+                remove_piece(to_square, *piece_type_on(to_square), !stm);
+                remove_piece(from_square, constants::PAWN, stm);
+                put_piece(to_square, *move.promotion_piece_type(), stm);
+                halfmoves_ = 0;
+                break;
+            case Move::Type::NONE:
+                break;
+        }
+        side_to_move_ = std::uint8_t((!stm).value());
+        checkers_ = attackers_to(king_square(!stm), stm);
+    }
+
+    void make_null_move() {
+        hash_ ^= zobrist::side_to_move_key();
+        clear_enpassant_square();
+        ++halfmoves_;
+        if (side_to_move() == constants::BLACK) {
+            ++fullmoves_;
+        }
+        side_to_move_ = std::uint8_t((!side_to_move()).value());
+        checkers_ = attackers_to(king_square(side_to_move()), !side_to_move());
+    }
+
+    // Move Generation; the same legal generator as Position, with the pins computed here as a
+    // Board does not cache them
+    void generate_legal_moves(MoveList& move_list, Color stm) const {
+        Bitboard checkers = stm == side_to_move() ? checkers_
+                                                  : attackers_to(king_square(stm), !stm);
+        movegen::generate_legal_moves(*this, move_list, stm, checkers, pinned_pieces_of(stm));
+    }
+    void generate_legal_captures(MoveList& move_list) const {
+        Color stm = side_to_move();
+        movegen::generate_legal_moves(
+            *this, move_list, stm, checkers_, pinned_pieces_of(stm), true);
+    }
+    void generate_legal_quiets(MoveList& move_list) const {
+        Color stm = side_to_move();
+        movegen::generate_legal_moves(
+            *this, move_list, stm, checkers_, pinned_pieces_of(stm), false);
+    }
+    MoveList legal_move_list() const {
+        MoveList move_list;
+        generate_legal_moves(move_list, side_to_move());
+        return move_list;
+    }
+    MoveList legal_capture_list() const {
+        MoveList move_list;
+        generate_legal_captures(move_list);
+        return move_list;
+    }
+    MoveList legal_quiet_list() const {
+        MoveList move_list;
+        generate_legal_quiets(move_list);
+        return move_list;
+    }
+    int legal_move_count() const {
+        Color stm = side_to_move();
+        return movegen::legal_move_count(*this, stm, checkers_, pinned_pieces_of(stm));
+    }
+    bool has_legal_move() const {
+        Color stm = side_to_move();
+        return movegen::has_legal_move(*this, stm, checkers_, pinned_pieces_of(stm));
+    }
+
+    // Static exchange evaluation, as on Position
+    std::optional<Move> smallest_capture_move_to(Square square) const {
+        return movegen::smallest_capture_move_to(*this, square);
+    }
+    int see_to(Square square, std::array<int, 6> piece_values) const {
+        return movegen::see_to(*this, square, piece_values);
+    }
+    int see_for(Move move, std::array<int, 6> piece_values) const {
+        return movegen::see_for(*this, move, piece_values);
+    }
+    bool see_ge(Move move,
+                int threshold,
+                std::array<int, 6> piece_values = constants::SEE_PIECE_VALUES) const {
+        return movegen::see_ge(*this, move, threshold, piece_values);
+    }
+
+   private:
+    friend class Position;
+
+    constexpr static std::uint8_t NO_SQUARE = 64;
+
+    bool enpassant_capture_possible(Square enpassant_square, Color c) const {
+        return piece_type_bb(constants::PAWN, c) & lookups::pawn_attacks(enpassant_square, !c);
+    }
+    void clear_enpassant_square() {
+        auto ep_sq = enpassant_square();
+        if (ep_sq && enpassant_capture_possible(*ep_sq, side_to_move())) {
+            hash_ ^= zobrist::enpassant_key(*ep_sq);
+        }
+        enpassant_square_ = NO_SQUARE;
+    }
+
+    void toggle_piece(Square square, PieceType piece_type, Color color) {
+        Bitboard square_bb{square};
+        piece_type_bb_[piece_type.value()] ^= square_bb;
+        color_bb_[color.value()] ^= square_bb;
+        hash_type key = zobrist::piece_square_key(square, piece_type, color);
+        hash_ ^= key;
+        if (piece_type == constants::PAWN) {
+            pawn_hash_ ^= key;
+        }
+    }
+    void put_piece(Square square, PieceType piece_type, Color color) {
+        toggle_piece(square, piece_type, color);
+    }
+    void remove_piece(Square square, PieceType piece_type, Color color) {
+        toggle_piece(square, piece_type, color);
+    }
+    void move_piece(Square from_square, Square to_square, PieceType piece_type, Color color) {
+        toggle_piece(from_square, piece_type, color);
+        toggle_piece(to_square, piece_type, color);
+    }
+
+    Bitboard piece_type_bb_[6];
+    Bitboard color_bb_[2];
+    Bitboard checkers_;
+    hash_type hash_ = 0;
+    hash_type pawn_hash_ = 0;
+    std::uint16_t halfmoves_ = 0;
+    std::uint16_t fullmoves_ = 1;
+    std::uint8_t side_to_move_ = 0;
+    std::uint8_t castling_rights_ = 0;
+    std::uint8_t enpassant_square_ = NO_SQUARE;
+};
+
+static_assert(std::is_trivially_copyable_v<Board>);
+static_assert(sizeof(Board) <= 128);
+
+}  // namespace libchess
+
+#endif  // LIBCHESS_BOARD_H
@@ -2,10 +2,15 @@
 #define LIBCHESS_LOOKUPS_H
 
 #include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
 
 #include "Bitboard.h"
 #include "Color.h"
 #include "PieceType.h"
+#include "internal/CpuFeatures.h"
+#include "internal/Magics.h"
 
 namespace libchess::lookups {
 
@@ -54,7 +59,7 @@ namespace init {
 
 constexpr inline std::array<Bitboard, 64> north() {
     std::array<Bitboard, 64> attacks{};
-    for (Square sq = constants::A1; sq <= constants::H7; ++sq) {
+    for (Square sq = constants::A1; sq <= constants::H8; ++sq) {
         Bitboard bb;
         for (Square atk_sq = sq + 8; atk_sq <= constants::H8; atk_sq = atk_sq + 8) {
             bb |= Bitboard{atk_sq};
@@ -66,7 +71,7 @@ constexpr inline std::array<Bitboard, 64> north() {
 
 constexpr inline std::array<Bitboard, 64> south() {
     std::array<Bitboard, 64> attacks{};
-    for (Square sq = constants::A2; sq <= constants::H8; ++sq) {
+    for (Square sq = constants::A1; sq <= constants::H8; ++sq) {
         Bitboard bb;
         for (Square atk_sq = sq - 8; atk_sq >= constants::A1; atk_sq = atk_sq - 8) {
             bb |= Bitboard{atk_sq};
@@ -78,7 +83,7 @@ constexpr inline std::array<Bitboard, 64> south() {
 
 constexpr inline std::array<Bitboard, 64> east() {
     std::array<Bitboard, 64> attacks{};
-    for (Square sq = constants::A1; sq <= constants::G8; ++sq) {
+    for (Square sq = constants::A1; sq <= constants::H8; ++sq) {
         Bitboard bb;
         for (Square atk_sq = sq + 1; atk_sq <= constants::H8; atk_sq = atk_sq + 1) {
             if (Bitboard{atk_sq} & FILE_A_MASK) {
@@ -93,7 +98,7 @@ constexpr inline std::array<Bitboard, 64> east() {
 
 constexpr inline std::array<Bitboard, 64> west() {
     std::array<Bitboard, 64> attacks{};
-    for (Square sq = constants::B1; sq <= constants::H8; ++sq) {
+    for (Square sq = constants::A1; sq <= constants::H8; ++sq) {
         Bitboard bb;
         for (Square atk_sq = sq - 1; atk_sq >= constants::A1; atk_sq = atk_sq - 1) {
             if (Bitboard{atk_sq} & FILE_H_MASK) {
@@ -108,7 +113,7 @@ constexpr inline std::array<Bitboard, 64> west() {
 
 constexpr inline std::array<Bitboard, 64> northwest() {
     std::array<Bitboard, 64> attacks{};
-    for (Square sq = constants::A1; sq <= constants::H7; ++sq) {
+    for (Square sq = constants::A1; sq <= constants::H8; ++sq) {
         Bitboard bb;
         for (Square atk_sq = sq + 7; atk_sq <= constants::H8; atk_sq = atk_sq + 7) {
             if (Bitboard{atk_sq} & FILE_H_MASK) {
@@ -123,7 +128,7 @@ constexpr inline std::array<Bitboard, 64> northwest() {
 
 constexpr inline std::array<Bitboard, 64> southwest() {
     std::array<Bitboard, 64> attacks{};
-    for (Square sq = constants::B2; sq <= constants::H8; ++sq) {
+    for (Square sq = constants::A1; sq <= constants::H8; ++sq) {
         Bitboard bb;
         for (Square atk_sq = sq - 9; atk_sq >= constants::A1; atk_sq = atk_sq - 9) {
             if (Bitboard{atk_sq} & FILE_H_MASK) {
@@ -138,7 +143,7 @@ constexpr inline std::array<Bitboard, 64> southwest() {
 
 constexpr inline std::array<Bitboard, 64> northeast() {
     std::array<Bitboard, 64> attacks{};
-    for (Square sq = constants::A1; sq <= constants::G7; ++sq) {
+    for (Square sq = constants::A1; sq <= constants::H8; ++sq) {
         Bitboard bb;
         for (Square atk_sq = sq + 9; atk_sq <= constants::H8; atk_sq = atk_sq + 9) {
             if (Bitboard{atk_sq} & FILE_A_MASK) {
@@ -153,7 +158,7 @@ constexpr inline std::array<Bitboard, 64> northeast() {
 
 constexpr inline std::array<Bitboard, 64> southeast() {
     std::array<Bitboard, 64> attacks{};
-    for (Square sq = constants::A2; sq <= constants::H8; ++sq) {
+    for (Square sq = constants::A1; sq <= constants::H8; ++sq) {
         Bitboard bb;
         for (Square atk_sq = sq - 7; atk_sq >= constants::A1; atk_sq = atk_sq - 7) {
             if (Bitboard{atk_sq} & FILE_A_MASK) {
@@ -380,7 +385,7 @@ constexpr inline Bitboard rook_attacks(Square square) {
 constexpr inline Bitboard queen_attacks(Square square) {
     return QUEEN_ATTACKS[square];
 }
-constexpr inline Bitboard bishop_attacks(Square square, Bitboard occupancy) {
+constexpr inline Bitboard classical_bishop_attacks(Square square, Bitboard occupancy) {
     Bitboard attacks = bishop_attacks(square);
     Bitboard nw_blockers = (northwest(square) & occupancy) | Bitboard{constants::A8};
     Bitboard ne_blockers = (northeast(square) & occupancy) | Bitboard{constants::H8};
@@ -393,7 +398,7 @@ constexpr inline Bitboard bishop_attacks(Square square, Bitboard occupancy) {
     attacks ^= southeast(se_blockers.reverse_bitscan());
     return attacks;
 }
-inline Bitboard rook_attacks(Square square, Bitboard occupancy) {
+constexpr inline Bitboard classical_rook_attacks(Square square, Bitboard occupancy) {
     Bitboard attacks = rook_attacks(square);
     Bitboard n_blockers = (north(square) & occupancy) | Bitboard{constants::H8};
     Bitboard s_blockers = (south(square) & occupancy) | Bitboard{constants::A1};
@@ -406,7 +411,7 @@ inline Bitboard rook_attacks(Square square, Bitboard occupancy) {
     attacks ^= east(e_blockers.forward_bitscan());
     return attacks;
 }
-inline Bitboard queen_attacks(Square square, Bitboard occupancy) {
+constexpr inline Bitboard classical_queen_attacks(Square square, Bitboard occupancy) {
     Bitboard attacks = queen_attacks(square);
     Bitboard nw_blockers = (northwest(square) & occupancy) | Bitboard{constants::A8};
     Bitboard ne_blockers = (northeast(square) & occupancy) | Bitboard{constants::H8};
@@ -427,6 +432,277 @@ inline Bitboard queen_attacks(Square square, Bitboard occupancy) {
     attacks ^= east(e_blockers.forward_bitscan());
     return attacks;
 }
+namespace init {
+
+inline Bitboard bishop_relevant_occupancy_mask(Square square) {
+    return lookups::bishop_attacks(square) &
+           ~(RANK_1_MASK | RANK_8_MASK | FILE_A_MASK | FILE_H_MASK);
+}
+
+inline Bitboard rook_relevant_occupancy_mask(Square square) {
+    return (lookups::north(square) & ~RANK_8_MASK) | (lookups::south(square) & ~RANK_1_MASK) |
+           (lookups::east(square) & ~FILE_H_MASK) | (lookups::west(square) & ~FILE_A_MASK);
+}
+
+}  // namespace init
+
+enum class SliderBackend
+{
+    MAGIC,
+    PEXT
+};
+
+inline const char* to_str(SliderBackend backend) {
+    switch (backend) {
+        case SliderBackend::MAGIC:
+            return "magic";
+        case SliderBackend::PEXT:
+            return "pext";
+        default:
+            return "unknown";
+    }
+}
+
+struct Magic {
+    Bitboard mask;
+    std::uint64_t magic;
+    const Bitboard* attacks;
+    unsigned shift;
+
+    unsigned magic_index(Bitboard occupancy) const {
+        return unsigned(((occupancy & mask) * magic) >> shift);
+    }
+#ifdef LIBCHESS_HAS_PEXT
+    unsigned pext_index(Bitboard occupancy) const {
+        return unsigned(cpu::pext(occupancy, mask));
+    }
+#endif
+};
+
+/// Slider attack tables for bishops and rooks, built from the classical ray attacks. Each square
+/// owns a slice of one shared table, indexed by a fancy magic multiply and shift or, for the PEXT
+/// table, by a single PEXT of the occupancy against the square's relevant mask. The backend is a
+/// template parameter, so a magic lookup inlines into its caller and a PEXT lookup is a direct call
+/// into BMI2 code. A table is immutable once built.
+template <SliderBackend backend>
+class SliderAttackTable {
+   public:
+    constexpr static int BISHOP_TABLE_SIZE = 5248;
+    constexpr static int ROOK_TABLE_SIZE = 102400;
+
+    SliderAttackTable() {
+        Bitboard* next_attacks = attacks_.data();
+        for (Square sq = constants::A1; sq <= constants::H8; ++sq) {
+            next_attacks = init_entry(bishop_magics_[sq],
+                                      sq,
+                                      init::bishop_relevant_occupancy_mask(sq),
+                                      magics::bishop_magics[sq],
+                                      next_attacks,
+                                      classical_bishop_attacks);
+        }
+        for (Square sq = constants::A1; sq <= constants::H8; ++sq) {
+            next_attacks = init_entry(rook_magics_[sq],
+                                      sq,
+                                      init::rook_relevant_occupancy_mask(sq),
+                                      magics::rook_magics[sq],
+                                      next_attacks,
+                                      classical_rook_attacks);
+        }
+    }
+    SliderAttackTable(const SliderAttackTable&) = delete;
+    SliderAttackTable& operator=(const SliderAttackTable&) = delete;
+
+    Bitboard bishop_attacks(Square square, Bitboard occupancy) const {
+        return attacks_for(bishop_magics_[square], occupancy);
+    }
+    Bitboard rook_attacks(Square square, Bitboard occupancy) const {
+        return attacks_for(rook_magics_[square], occupancy);
+    }
+
+   private:
+    static Bitboard attacks_for(const Magic& entry, Bitboard occupancy) {
+#ifdef LIBCHESS_HAS_PEXT
+        if constexpr (backend == SliderBackend::PEXT) {
+            return pext_attacks_for(entry, occupancy);
+        }
+#endif
+        return entry.attacks[entry.magic_index(occupancy)];
+    }
+#ifdef LIBCHESS_HAS_PEXT
+    __attribute__((target("bmi2"))) static Bitboard pext_attacks_for(const Magic& entry,
+                                                                     Bitboard occupancy) {
+        return entry.attacks[_pext_u64(occupancy, entry.mask)];
+    }
+#endif
+
+    template <class F>
+    static Bitboard* init_entry(Magic& entry,
+                                Square square,
+                                Bitboard mask,
+                                std::uint64_t magic_number,
+                                Bitboard* attacks,
+                                F classical_attacks) {
+        entry.mask = mask;
+        entry.magic = magic_number;
+        entry.attacks = attacks;
+        entry.shift = 64 - mask.popcount();
+
+        // Carry-rippler enumeration of every subset of the mask
+        Bitboard occupancy{0};
+        do {
+            attacks[index_of(entry, occupancy)] = classical_attacks(square, occupancy);
+            occupancy = Bitboard{(Bitboard::value_type(occupancy) - mask) & mask};
+        } while (occupancy);
+        return attacks + (std::size_t(1) << mask.popcount());
+    }
+
+    static unsigned index_of(const Magic& entry, Bitboard occupancy) {
+#ifdef LIBCHESS_HAS_PEXT
+        if constexpr (backend == SliderBackend::PEXT) {
+            return entry.pext_index(occupancy);
+        }
+#endif
+        return entry.magic_index(occupancy);
+    }
+
+    std::array<Magic, 64> bishop_magics_;
+    std::array<Magic, 64> rook_magics_;
+    std::array<Bitboard, BISHOP_TABLE_SIZE + ROOK_TABLE_SIZE> attacks_;
+};
+
+/// The slider tables in use. The magic table is always built. The PEXT table is built the first
+/// time it is selected, and only on CPUs that have PEXT. A lookup reads the selected backend from
+/// one flag: the magic path stays inline, and the PEXT path is one direct call. Built tables are
+/// never modified or freed, so switching the backend is safe while other threads are looking up
+/// attacks; a lookup that races with a switch uses one table or the other.
+class SliderAttacks {
+   public:
+    SliderAttacks() {
+        set_backend(best_supported_backend());
+    }
+    SliderAttacks(const SliderAttacks&) = delete;
+    SliderAttacks& operator=(const SliderAttacks&) = delete;
+
+    static bool is_supported(SliderBackend backend) {
+        return backend == SliderBackend::MAGIC || cpu::supports_pext();
+    }
+    static SliderBackend best_supported_backend() {
+        return cpu::has_fast_pext() ? SliderBackend::PEXT : SliderBackend::MAGIC;
+    }
+
+    SliderBackend backend() const {
+        return use_pext() ? SliderBackend::PEXT : SliderBackend::MAGIC;
+    }
+    bool set_backend(SliderBackend backend) {
+        if (!is_supported(backend)) {
+            return false;
+        }
+#ifdef LIBCHESS_HAS_PEXT
+        if (backend == SliderBackend::PEXT) {
+            std::call_once(pext_table_built_, [this] {
+                pext_table_ = std::make_unique<SliderAttackTable<SliderBackend::PEXT>>();
+            });
+        }
+        use_pext_.store(backend == SliderBackend::PEXT, std::memory_order_release);
+#endif
+        return true;
+    }
+
+    Bitboard bishop_attacks(Square square, Bitboard occupancy) const {
+#ifdef LIBCHESS_HAS_PEXT
+        if (use_pext()) {
+            return pext_table_->bishop_attacks(square, occupancy);
+        }
+#endif
+        return magic_table_.bishop_attacks(square, occupancy);
+    }
+    Bitboard rook_attacks(Square square, Bitboard occupancy) const {
+#ifdef LIBCHESS_HAS_PEXT
+        if (use_pext()) {
+            return pext_table_->rook_attacks(square, occupancy);
+        }
+#endif
+        return magic_table_.rook_attacks(square, occupancy);
+    }
+    Bitboard queen_attacks(Square square, Bitboard occupancy) const {
+#ifdef LIBCHESS_HAS_PEXT
+        if (use_pext()) {
+            return pext_table_->bishop_attacks(square, occupancy) |
+                   pext_table_->rook_attacks(square, occupancy);
+        }
+#endif
+        return magic_table_.bishop_attacks(square, occupancy) |
+               magic_table_.rook_attacks(square, occupancy);
+    }
+
+   private:
+    bool use_pext() const {
+#ifdef LIBCHESS_HAS_PEXT
+        // Acquire pairs with set_backend() so that a selected PEXT table is seen fully built
+        return use_pext_.load(std::memory_order_acquire);
+#else
+        return false;
+#endif
+    }
+
+    SliderAttackTable<SliderBackend::MAGIC> magic_table_;
+#ifdef LIBCHESS_HAS_PEXT
+    std::unique_ptr<SliderAttackTable<SliderBackend::PEXT>> pext_table_;
+    std::once_flag pext_table_built_;
+    std::atomic<bool> use_pext_{false};
+#endif
+};
+
+inline SliderAttacks SLIDER_ATTACKS;
+
+inline SliderBackend slider_backend() {
+    return SLIDER_ATTACKS.backend();
+}
+// Switches the tables to the requested backend, building them on first use. Returns false if
+// this CPU cannot run it. Safe to call while other threads look up attacks.
+inline bool set_slider_backend(SliderBackend backend) {
+    return SLIDER_ATTACKS.set_backend(backend);
+}
+inline const char* slider_backend_name() {
+#ifdef LIBCHESS_CLASSICAL_SLIDER_ATTACKS
+    return "classical";
+#else
+    return to_str(slider_backend());
+#endif
+}
+
+inline Bitboard magic_bishop_attacks(Square square, Bitboard occupancy) {
+    return SLIDER_ATTACKS.bishop_attacks(square, occupancy);
+}
+inline Bitboard magic_rook_attacks(Square square, Bitboard occupancy) {
+    return SLIDER_ATTACKS.rook_attacks(square, occupancy);
+}
+inline Bitboard magic_queen_attacks(Square square, Bitboard occupancy) {
+    return SLIDER_ATTACKS.queen_attacks(square, occupancy);
+}
+
+// Define LIBCHESS_CLASSICAL_SLIDER_ATTACKS to fall back to the ray-scanning implementation
+inline Bitboard bishop_attacks(Square square, Bitboard occupancy) {
+#ifdef LIBCHESS_CLASSICAL_SLIDER_ATTACKS
+    return classical_bishop_attacks(square, occupancy);
+#else
+    return magic_bishop_attacks(square, occupancy);
+#endif
+}
+inline Bitboard rook_attacks(Square square, Bitboard occupancy) {
+#ifdef LIBCHESS_CLASSICAL_SLIDER_ATTACKS
+    return classical_rook_attacks(square, occupancy);
+#else
+    return magic_rook_attacks(square, occupancy);
+#endif
+}
+inline Bitboard queen_attacks(Square square, Bitboard occupancy) {
+#ifdef LIBCHESS_CLASSICAL_SLIDER_ATTACKS
+    return classical_queen_attacks(square, occupancy);
+#else
+    return magic_queen_attacks(square, occupancy);
+#endif
+}
 inline Bitboard pawn_shift(Bitboard bb, Color c, int times = 1) {
     return c == constants::WHITE ? bb << (8 * times) : bb >> (8 * times);
 }
@@ -506,6 +782,25 @@ inline Bitboard full_ray(Square from, Square to) {
     return FULL_RAY[from][to];
 }
 
+// Castling rights that survive a move from or to each square; the king and rook home squares
+// clear the rights they take part in
+// clang-format off
+constexpr static std::array<int, 64> CASTLING_SPOILERS = {
+    13, 15, 15, 15, 12, 15, 15, 14,
+    15, 15, 15, 15, 15, 15, 15, 15,
+    15, 15, 15, 15, 15, 15, 15, 15,
+    15, 15, 15, 15, 15, 15, 15, 15,
+    15, 15, 15, 15, 15, 15, 15, 15,
+    15, 15, 15, 15, 15, 15, 15, 15,
+    15, 15, 15, 15, 15, 15, 15, 15,
+    7,  15, 15, 15, 3,  15, 15, 11
+};
+// clang-format on
+
+inline int castling_spoilers(Square square) {
+    return CASTLING_SPOILERS[square];
+}
+
 }  // namespace libchess::lookups
 
 #endif  // LIBCHESS_LOOKUPS_H
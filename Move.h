@@ -2,6 +2,8 @@
 #define LIBCHESS_MOVE_H
 
 #include <algorithm>
+#include <array>
+#include <cassert>
 #include <optional>
 #include <vector>
 
@@ -121,88 +123,148 @@ class Move {
     value_type value_;
 };
 
+// Holds the moves in place instead of on the heap, so that generating moves does not allocate.
+// A position has at most 218 legal moves.
 class MoveList {
    public:
+    constexpr static int MAX_SIZE = 256;
+
     using value_type = std::vector<Move>;
-    using iterator = value_type::iterator;
-    using const_iterator = value_type::const_iterator;
+    using iterator = Move*;
+    using const_iterator = const Move*;
+
+    // A view of the moves held in a MoveList, valid while the list is alive and not added to. It
+    // compares equal to, and converts to, the std::vector values() returned before the moves were
+    // stored in place.
+    template <typename T>
+    class Span {
+       public:
+        Span(T* data, int size) : data_(data), size_(size) {
+        }
+
+        T* begin() const {
+            return data_;
+        }
+        T* end() const {
+            return data_ + size_;
+        }
+        T* data() const {
+            return data_;
+        }
+        T& operator[](int index) const {
+            return data_[index];
+        }
+        int size() const {
+            return size_;
+        }
+        bool empty() const {
+            return size_ == 0;
+        }
+        operator value_type() const {
+            return value_type(begin(), end());
+        }
+        friend bool operator==(const Span& lhs, const value_type& rhs) {
+            return std::equal(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+        }
+        friend bool operator==(const value_type& lhs, const Span& rhs) {
+            return rhs == lhs;
+        }
+        friend bool operator!=(const Span& lhs, const value_type& rhs) {
+            return !(lhs == rhs);
+        }
+        friend bool operator!=(const value_type& lhs, const Span& rhs) {
+            return !(rhs == lhs);
+        }
 
-    MoveList() {
-        values_.reserve(32);
+       private:
+        T* data_;
+        int size_;
+    };
+
+    MoveList() : size_(0) {
     }
 
     iterator begin() {
-        return values_.begin();
+        return values_.data();
     }
     iterator end() {
-        return values_.end();
+        return values_.data() + size_;
+    }
+    const_iterator begin() const {
+        return values_.data();
+    }
+    const_iterator end() const {
+        return values_.data() + size_;
     }
     const_iterator cbegin() const {
-        return values_.cbegin();
+        return values_.data();
     }
     const_iterator cend() const {
-        return values_.cend();
+        return values_.data() + size_;
     }
 
     void pop_back() {
-        values_.pop_back();
+        --size_;
     }
     void add(Move move) {
-        values_.push_back(move);
+        assert(size_ < MAX_SIZE);
+        values_[size_++] = move;
     }
     void add(const MoveList& move_list) noexcept {
-        values_.reserve(size() + move_list.size());
         for (auto iter = move_list.cbegin(); iter != move_list.cend(); ++iter) {
             add(*iter);
         }
     }
     template <class F>
     void sort(F move_evaluator) {
-        auto& moves = values_mut_ref();
-        std::vector<int> scores;
-        scores.resize(values_.size());
+        std::array<int, MAX_SIZE> scores;
         for (int i = 0; i < size(); ++i) {
-            scores[i] = move_evaluator(moves[i]);
+            scores[i] = move_evaluator(values_[i]);
         }
         for (int i = 1; i < size(); ++i) {
-            Move moving_move = moves[i];
+            Move moving_move = values_[i];
             int moving_score = scores[i];
             int j = i;
             for (; j > 0; --j) {
                 if (scores[j - 1] < moving_score) {
                     scores[j] = scores[j - 1];
-                    moves[j] = moves[j - 1];
+                    values_[j] = values_[j - 1];
                 } else {
                     break;
                 }
             }
             scores[j] = moving_score;
-            moves[j] = moving_move;
+            values_[j] = moving_move;
         }
     }
     void clear() noexcept {
-        values_.clear();
+        size_ = 0;
     }
     bool empty() const noexcept {
-        return values_.empty();
+        return size_ == 0;
     }
     int size() const {
-        return values_.size();
+        return size_;
     }
-    const value_type& values() const {
-        return values_;
+    Span<const Move> values() const {
+        return Span<const Move>{values_.data(), size_};
     }
     bool contains(Move move) const {
         return std::find(cbegin(), cend(), move) != cend();
     }
 
    protected:
-    value_type& values_mut_ref() {
-        return values_;
+    Span<Move> values_mut_ref() {
+        return Span<Move>{values_.data(), size_};
     }
 
    private:
-    value_type values_;
+    // Kept in a union so that the entries past size_ are left uninitialized rather than zeroed
+    // on every construction
+    union {
+        std::array<Move, MAX_SIZE> values_;
+    };
+    int size_;
 };
 
 inline std::ostream& operator<<(std::ostream& ostream, Move move) {
@@ -0,0 +1,235 @@
+#ifndef LIBCHESS_MOVEPICKER_H
+#define LIBCHESS_MOVEPICKER_H
+
+#include <array>
+#include <optional>
+
+#include "Move.h"
+#include "Position.h"
+
+namespace libchess {
+
+/// Yields the legal moves of a position one at a time, in the order a search wants to try them:
+/// the TT move, captures that do not lose material by SEE, killers, quiets by history and finally
+/// the losing captures. Each stage is only generated once the previous one is exhausted, and moves
+/// are picked by a selection step rather than sorted upfront, so a cutoff on the first move or two
+/// costs little more than the move that caused it. Positions in check go through a single stage of
+/// evasions after the TT move.
+class MovePicker {
+   public:
+    /// Quiet move history scores indexed by [from][to]
+    using ButterflyHistory = std::array<std::array<int, 64>, 64>;
+
+    enum class Stage
+    {
+        TT_MOVE,
+        GENERATE_CAPTURES,
+        GOOD_CAPTURES,
+        KILLERS,
+        GENERATE_QUIETS,
+        QUIETS,
+        BAD_CAPTURES,
+        GENERATE_EVASIONS,
+        EVASIONS,
+        DONE
+    };
+
+    MovePicker(const Position& pos,
+               std::optional<Move> tt_move = std::nullopt,
+               std::array<Move, 2> killers = {},
+               const ButterflyHistory* history = nullptr,
+               std::array<int, 6> piece_values = constants::SEE_PIECE_VALUES)
+        : pos_(pos),
+          tt_move_(tt_move.value_or(Move{})),
+          killers_(killers),
+          history_(history),
+          piece_values_(piece_values),
+          stage_(Stage::TT_MOVE),
+          current_(0),
+          killer_index_(0),
+          played_killers_{},
+          bad_capture_index_(0) {
+    }
+
+    std::optional<Move> next_move() {
+        while (true) {
+            switch (stage_) {
+                case Stage::TT_MOVE:
+                    stage_ = pos_.in_check() ? Stage::GENERATE_EVASIONS : Stage::GENERATE_CAPTURES;
+                    if (tt_move_ != Move{} && pos_.is_legal_move(tt_move_)) {
+                        return tt_move_;
+                    }
+                    break;
+                case Stage::GENERATE_CAPTURES:
+                    pos_.generate_capture_moves(moves_, pos_.side_to_move());
+                    score_captures();
+                    stage_ = Stage::GOOD_CAPTURES;
+                    break;
+                case Stage::GOOD_CAPTURES:
+                    while (current_ < moves_.size()) {
+                        Move move = pick_best();
+                        if (move == tt_move_ || !pos_.is_legal_generated_move(move)) {
+                            continue;
+                        }
+                        if (!pos_.see_ge(move, 0, piece_values_)) {
+                            bad_captures_.add(move);
+                            continue;
+                        }
+                        return move;
+                    }
+                    stage_ = Stage::KILLERS;
+                    break;
+                case Stage::KILLERS:
+                    while (killer_index_ < int(killers_.size())) {
+                        Move killer = killers_[killer_index_++];
+                        if (is_playable_killer(killer)) {
+                            played_killers_[killer_index_ - 1] = killer;
+                            return killer;
+                        }
+                    }
+                    stage_ = Stage::GENERATE_QUIETS;
+                    break;
+                case Stage::GENERATE_QUIETS:
+                    moves_.clear();
+                    current_ = 0;
+                    pos_.generate_quiet_moves(moves_, pos_.side_to_move());
+                    score_quiets();
+                    stage_ = Stage::QUIETS;
+                    break;
+                case Stage::QUIETS:
+                    while (current_ < moves_.size()) {
+                        Move move = pick_best();
+                        if (move == tt_move_ || is_played_killer(move) ||
+                            !pos_.is_legal_generated_move(move)) {
+                            continue;
+                        }
+                        return move;
+                    }
+                    stage_ = Stage::BAD_CAPTURES;
+                    break;
+                case Stage::BAD_CAPTURES:
+                    if (bad_capture_index_ < bad_captures_.size()) {
+                        return *(bad_captures_.begin() + bad_capture_index_++);
+                    }
+                    stage_ = Stage::DONE;
+                    break;
+                case Stage::GENERATE_EVASIONS:
+                    moves_ = pos_.check_evasion_move_list();
+                    score_evasions();
+                    stage_ = Stage::EVASIONS;
+                    break;
+                case Stage::EVASIONS:
+                    while (current_ < moves_.size()) {
+                        Move move = pick_best();
+                        if (move == tt_move_ || !pos_.is_legal_generated_move(move)) {
+                            continue;
+                        }
+                        return move;
+                    }
+                    stage_ = Stage::DONE;
+                    break;
+                case Stage::DONE:
+                    return std::nullopt;
+            }
+        }
+    }
+
+    Stage stage() const {
+        return stage_;
+    }
+
+   private:
+    // Queen promotions and evasion captures are tried before any move scored by history
+    constexpr static int CAPTURE_SCORE_OFFSET = 1 << 28;
+
+    int mvv_lva(Move move) const {
+        Move::Type move_type = pos_.move_type_of(move);
+        int score = 0;
+        if (move_type == Move::Type::ENPASSANT) {
+            score = piece_values_[constants::PAWN.value()];
+        } else if (auto captured_pt = pos_.piece_type_on(move.to_square())) {
+            score = piece_values_[captured_pt->value()];
+        }
+        if (auto promotion_pt = move.promotion_piece_type()) {
+            score += piece_values_[promotion_pt->value()];
+        }
+        // The most valuable victim first, then the least valuable attacker
+        return score * 8 - pos_.piece_type_on(move.from_square())->value();
+    }
+    void score_captures() {
+        for (int i = 0; i < moves_.size(); ++i) {
+            scores_[i] = mvv_lva(*(moves_.begin() + i));
+        }
+    }
+    void score_quiets() {
+        for (int i = 0; i < moves_.size(); ++i) {
+            Move move = *(moves_.begin() + i);
+            if (move.promotion_piece_type() == constants::QUEEN) {
+                scores_[i] = CAPTURE_SCORE_OFFSET;
+            } else {
+                scores_[i] = history_ ? (*history_)[move.from_square()][move.to_square()] : 0;
+            }
+        }
+    }
+    void score_evasions() {
+        score_quiets();
+        for (int i = 0; i < moves_.size(); ++i) {
+            Move move = *(moves_.begin() + i);
+            if (pos_.is_capture_move(move)) {
+                scores_[i] = CAPTURE_SCORE_OFFSET + mvv_lva(move);
+            }
+        }
+    }
+
+    // Selection step: swaps the best remaining move to the front of the remaining range
+    Move pick_best() {
+        auto moves = moves_.begin();
+        int best = current_;
+        for (int i = current_ + 1; i < moves_.size(); ++i) {
+            if (scores_[i] > scores_[best]) {
+                best = i;
+            }
+        }
+        std::swap(moves[current_], moves[best]);
+        std::swap(scores_[current_], scores_[best]);
+        return moves[current_++];
+    }
+
+    // Killers handed out in their own stage are skipped when the quiets are generated
+    bool is_played_killer(Move move) const {
+        return move == played_killers_[0] || move == played_killers_[1];
+    }
+    bool is_playable_killer(Move killer) const {
+        if (killer == Move{} || killer == tt_move_ || is_played_killer(killer) ||
+            !pos_.is_legal_move(killer)) {
+            return false;
+        }
+        switch (pos_.move_type_of(killer)) {
+            case Move::Type::CAPTURE:
+            case Move::Type::CAPTURE_PROMOTION:
+            case Move::Type::ENPASSANT:
+            case Move::Type::PROMOTION:
+                return false;
+            default:
+                return true;
+        }
+    }
+
+    const Position& pos_;
+    Move tt_move_;
+    std::array<Move, 2> killers_;
+    const ButterflyHistory* history_;
+    std::array<int, 6> piece_values_;
+    Stage stage_;
+    MoveList moves_;
+    std::array<int, MoveList::MAX_SIZE> scores_;
+    int current_;
+    int killer_index_;
+    std::array<Move, 2> played_killers_;
+    MoveList bad_captures_;
+    int bad_capture_index_;
+};
+
+}  // namespace libchess
+
+#endif  // LIBCHESS_MOVEPICKER_H
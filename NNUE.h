@@ -0,0 +1,173 @@
+#ifndef LIBCHESS_NNUE_H
+#define LIBCHESS_NNUE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <string>
+
+#include "Color.h"
+#include "Position.h"
+#include "internal/MappedFile.h"
+#include "internal/NNUEAccumulator.h"
+#include "internal/NNUEKernels.h"
+
+namespace libchess::nnue {
+
+constexpr int L1_INPUTS = 2 * HALF_DIMENSIONS;
+constexpr int L2_INPUTS = 32;
+constexpr int L3_INPUTS = 32;
+// Hidden layer sums are scaled down by 2^WEIGHT_SCALE_BITS before clipping, and the output by
+// OUTPUT_SCALE to get centipawns
+constexpr int WEIGHT_SCALE_BITS = 6;
+constexpr int OUTPUT_SCALE = 16;
+
+/// Layout of a network file. All values are little-endian, and each section starts on a 64-byte
+/// boundary so that the mapped weights can be read in place:
+///   Header
+///   int16 feature biases[HALF_DIMENSIONS]
+///   int16 feature weights[INPUT_DIMENSIONS][HALF_DIMENSIONS]
+///   int32 l1 biases[L2_INPUTS],  int8 l1 weights[L2_INPUTS][L1_INPUTS]
+///   int32 l2 biases[L3_INPUTS],  int8 l2 weights[L3_INPUTS][L2_INPUTS]
+///   int32 output bias, padded to 64 bytes,  int8 output weights[L3_INPUTS], padded to 64 bytes
+namespace layout {
+
+struct Header {
+    std::uint32_t magic;
+    std::uint32_t version;
+    std::uint32_t input_dimensions;
+    std::uint32_t half_dimensions;
+    std::uint32_t l2_inputs;
+    std::uint32_t l3_inputs;
+    std::uint32_t reserved[10];
+};
+static_assert(sizeof(Header) == 64);
+
+constexpr std::uint32_t MAGIC = 0x4e4e434c;  // "LCNN"
+constexpr std::uint32_t VERSION = 1;
+
+constexpr std::size_t padded(std::size_t size) {
+    return (size + 63) / 64 * 64;
+}
+
+constexpr std::size_t FT_BIASES = sizeof(Header);
+constexpr std::size_t FT_WEIGHTS = FT_BIASES + padded(HALF_DIMENSIONS * sizeof(std::int16_t));
+constexpr std::size_t L1_BIASES =
+    FT_WEIGHTS + padded(std::size_t(INPUT_DIMENSIONS) * HALF_DIMENSIONS * sizeof(std::int16_t));
+constexpr std::size_t L1_WEIGHTS = L1_BIASES + padded(L2_INPUTS * sizeof(std::int32_t));
+constexpr std::size_t L2_BIASES = L1_WEIGHTS + padded(L2_INPUTS * L1_INPUTS);
+constexpr std::size_t L2_WEIGHTS = L2_BIASES + padded(L3_INPUTS * sizeof(std::int32_t));
+constexpr std::size_t OUTPUT_BIAS = L2_WEIGHTS + padded(L3_INPUTS * L2_INPUTS);
+constexpr std::size_t OUTPUT_WEIGHTS = OUTPUT_BIAS + padded(sizeof(std::int32_t));
+constexpr std::size_t FILE_SIZE = OUTPUT_WEIGHTS + padded(L3_INPUTS);
+
+}  // namespace layout
+
+/// A HalfKP network read in place from a memory-mapped file: a 40960 -> 2x256 feature
+/// transformer with int16 accumulators, then clipped-ReLU int8 layers of 512 -> 32 -> 32 -> 1.
+/// Position keeps the accumulators once given a network with set_network(); this class only
+/// holds the weights and runs the layers, with the kernel picked at load time. Position.h
+/// includes this header, which defines the Position members that use a network.
+class Network {
+   public:
+    static std::optional<Network> load(const std::string& path,
+                                       Kernel kernel = kernels::best_supported_kernel()) {
+        auto file = MappedFile::open(path);
+        if (!file || file->size() != layout::FILE_SIZE) {
+            return std::nullopt;
+        }
+        layout::Header header;
+        std::memcpy(&header, file->data(), sizeof(header));
+        if (header.magic != layout::MAGIC || header.version != layout::VERSION ||
+            header.input_dimensions != INPUT_DIMENSIONS ||
+            header.half_dimensions != HALF_DIMENSIONS || header.l2_inputs != L2_INPUTS ||
+            header.l3_inputs != L3_INPUTS) {
+            return std::nullopt;
+        }
+        return Network{std::move(*file), kernel};
+    }
+
+    Kernel kernel() const {
+        return kernel_;
+    }
+    // Returns false if this CPU cannot run the kernel
+    bool set_kernel(Kernel kernel) {
+        if (!kernels::is_supported(kernel)) {
+            return false;
+        }
+        kernel_ = kernel;
+        return true;
+    }
+
+    void reset(Accumulator& accumulator, Color perspective) const {
+        std::memcpy(accumulator.values[perspective.value()],
+                    section<std::int16_t>(layout::FT_BIASES),
+                    sizeof(accumulator.values[0]));
+    }
+    void add_feature(Accumulator& accumulator, Color perspective, int index) const {
+        kernels::add_row(
+            kernel_, accumulator.values[perspective.value()], feature_row(index), HALF_DIMENSIONS);
+    }
+    void remove_feature(Accumulator& accumulator, Color perspective, int index) const {
+        kernels::sub_row(
+            kernel_, accumulator.values[perspective.value()], feature_row(index), HALF_DIMENSIONS);
+    }
+
+    // Evaluation in centipawns from the side to move's point of view
+    int evaluate(const Accumulator& accumulator, Color stm) const {
+        alignas(64) std::uint8_t l1_input[L1_INPUTS];
+        alignas(64) std::uint8_t l2_input[L2_INPUTS];
+        alignas(64) std::uint8_t l3_input[L3_INPUTS];
+        const std::int16_t* us = accumulator.values[stm.value()];
+        const std::int16_t* them = accumulator.values[(!stm).value()];
+        kernels::clipped_relu(kernel_, us, l1_input, HALF_DIMENSIONS);
+        kernels::clipped_relu(kernel_, them, l1_input + HALF_DIMENSIONS, HALF_DIMENSIONS);
+        hidden_layer<L1_INPUTS, L2_INPUTS>(
+            layout::L1_BIASES, layout::L1_WEIGHTS, l1_input, l2_input);
+        hidden_layer<L2_INPUTS, L3_INPUTS>(
+            layout::L2_BIASES, layout::L2_WEIGHTS, l2_input, l3_input);
+        std::int32_t output = *section<std::int32_t>(layout::OUTPUT_BIAS) +
+                              kernels::dot(kernel_,
+                                           l3_input,
+                                           section<std::int8_t>(layout::OUTPUT_WEIGHTS),
+                                           L3_INPUTS);
+        return output / OUTPUT_SCALE;
+    }
+
+   private:
+    Network(MappedFile file, Kernel kernel) : file_(std::move(file)) {
+        kernel_ = kernels::is_supported(kernel) ? kernel : Kernel::SCALAR;
+    }
+
+    template <class T>
+    const T* section(std::size_t offset) const {
+        return reinterpret_cast<const T*>(static_cast<const char*>(file_.data()) + offset);
+    }
+    const std::int16_t* feature_row(int index) const {
+        return section<std::int16_t>(layout::FT_WEIGHTS) + std::size_t(index) * HALF_DIMENSIONS;
+    }
+
+    template <int in_dims, int out_dims>
+    void hidden_layer(std::size_t biases_offset,
+                      std::size_t weights_offset,
+                      const std::uint8_t* input,
+                      std::uint8_t* output) const {
+        const std::int32_t* biases = section<std::int32_t>(biases_offset);
+        const std::int8_t* weights = section<std::int8_t>(weights_offset);
+        for (int i = 0; i < out_dims; ++i) {
+            std::int32_t sum =
+                biases[i] + kernels::dot(kernel_, input, weights + i * in_dims, in_dims);
+            output[i] = std::uint8_t(std::clamp(sum >> WEIGHT_SCALE_BITS, 0, 127));
+        }
+    }
+
+    MappedFile file_;
+    Kernel kernel_;
+};
+
+}  // namespace libchess::nnue
+
+#include "Position/NNUE.h"
+
+#endif  // LIBCHESS_NNUE_H
@@ -0,0 +1,34 @@
+#ifndef LIBCHESS_PSQT_H
+#define LIBCHESS_PSQT_H
+
+#include <array>
+
+#include "Color.h"
+#include "PieceType.h"
+#include "Square.h"
+
+namespace libchess {
+
+/// Mid-game and end-game piece-square values, as seen by white, indexed by piece type and
+/// square. Black pieces read the vertically flipped square. Piece values are usually folded into
+/// the tables. A Position given a table with set_psqt() keeps the sums of both phases per color.
+struct PSQT {
+    std::array<std::array<int, 64>, 6> mg;
+    std::array<std::array<int, 64>, 6> eg;
+
+    constexpr int mg_value(Square square, PieceType piece_type, Color color) const {
+        return mg[piece_type.value()][relative_square(square, color).value()];
+    }
+    constexpr int eg_value(Square square, PieceType piece_type, Color color) const {
+        return eg[piece_type.value()][relative_square(square, color).value()];
+    }
+
+   private:
+    constexpr static Square relative_square(Square square, Color color) {
+        return color == constants::WHITE ? square : square.flipped();
+    }
+};
+
+}  // namespace libchess
+
+#endif  // LIBCHESS_PSQT_H
@@ -13,6 +13,8 @@ class Piece {
     constexpr Piece(PieceType piece_type, Color piece_color)
         : value_(piece_type.value() | (piece_color.value() << 3)) {
     }
+    constexpr explicit Piece(value_type value) : value_(value) {
+    }
 
     constexpr PieceType type() const {
         return PieceType{value_ & 7};
@@ -20,6 +22,9 @@ class Piece {
     constexpr Color color() const {
         return Color{value_ >> 3};
     }
+    constexpr value_type value() const {
+        return value_;
+    }
 
     constexpr bool operator==(const Piece rhs) const {
         return type() == rhs.type() && color() == rhs.color();
@@ -1,21 +1,31 @@
 #ifndef LIBCHESS_POSITION_H
 #define LIBCHESS_POSITION_H
 
+#include <cassert>
+#include <array>
 #include <cctype>
 #include <optional>
 #include <sstream>
 #include <string>
 #include <tuple>
+#include <utility>
 #include <vector>
 
 #include "Bitboard.h"
+#include "Board.h"
 #include "CastlingRights.h"
 #include "Color.h"
 #include "Lookups.h"
 #include "Move.h"
+#include "PSQT.h"
 #include "Piece.h"
 #include "PieceType.h"
 #include "Square.h"
+#include "internal/Cuckoo.h"
+#include "internal/HistoryStack.h"
+#include "internal/MoveGen.h"
+#include "internal/NNUEAccumulator.h"
+#include "internal/StaticExchange.h"
 #include "internal/Zobrist.h"
 
 namespace libchess {
@@ -26,9 +36,18 @@ static std::string STARTPOS_FEN = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w
 
 }  // namespace constants
 
+namespace nnue {
+class Network;
+}  // namespace nnue
+
 class Position {
    private:
-    Position() : side_to_move_(constants::WHITE), ply_(0) {
+    Position()
+        : side_to_move_(constants::WHITE),
+          ply_(0),
+          history_(MAX_PLY + 1),
+          check_info_history_(MAX_PLY + 1) {
+        mailbox_.fill(NO_PIECE);
     }
 
    public:
@@ -37,6 +56,14 @@ class Position {
     }
     using hash_type = std::uint64_t;
 
+    // Plies of accumulators set_network() allocates room for, each about 1 KB; deeper lines grow
+    // the stack once
+    constexpr static int ACCUMULATOR_PLIES = 64;
+
+    // Moves that can be made past the position a FEN describes before the history has to grow. A
+    // caller playing longer games on one Position can call reserve_history() to allocate up front.
+    constexpr static int MAX_PLY = 256;
+
     enum class GameState
     {
         IN_PROGRESS,
@@ -46,6 +73,19 @@ class Position {
         FIFTY_MOVES
     };
 
+    // Move categories for generate(). CAPTURES includes capture promotions and en passant, QUIETS
+    // the quiet promotions and castling, and QUIET_CHECKS the quiets that give check, directly or
+    // by uncovering a slider. All are pseudo-legal apart from LEGAL.
+    enum class GenType
+    {
+        CAPTURES,
+        QUIETS,
+        EVASIONS,
+        QUIET_CHECKS,
+        NON_EVASIONS,
+        LEGAL
+    };
+
     // Getters
     Bitboard piece_type_bb(PieceType piece_type) const;
     Bitboard piece_type_bb(PieceType piece_type, Color color) const;
@@ -61,23 +101,39 @@ class Position {
     std::optional<Piece> piece_on(Square square) const;
     hash_type hash() const;
     hash_type pawn_hash() const;
+    hash_type hash_after(Move move) const;
+    hash_type pawn_hash_after(Move move) const;
+    hash_type material_key() const;
+    int piece_count(PieceType piece_type, Color color) const;
+    const PSQT* psqt() const;
+    int psqt_mg(Color color) const;
+    int psqt_eg(Color color) const;
+    const nnue::Network* network() const;
+    const nnue::Accumulator& accumulator() const;
+    int nnue_evaluate() const;
     Square king_square(Color color) const;
     int halfmoves() const;
     int fullmoves() const;
     bool in_check() const;
     bool is_repeat(int times = 1) const;
     int repeat_count() const;
+    bool has_game_cycle(int ply) const;
     const std::string& start_fen() const;
     GameState game_state() const;
+    Board board() const;
 
     // Move Integration
     Move::Type move_type_of(Move move) const;
     bool is_capture_move(Move move) const;
     bool is_promotion_move(Move move) const;
+    bool gives_check(Move move) const;
     bool is_legal_move(Move move) const;
     bool is_legal_generated_move(Move move) const;
+    struct UndoInfo;
     void unmake_move();
     void make_move(Move move);
+    void make_move(Move move, UndoInfo& undo);
+    void unmake_move(Move move, const UndoInfo& undo);
     void make_null_move();
 
     // Attacks
@@ -88,6 +144,9 @@ class Position {
     Bitboard attackers_to(Square square, Bitboard occupancy, Color c) const;
     Bitboard attacks_of_piece_on(Square square) const;
     Bitboard pinned_pieces_of(Color c) const;
+    Bitboard king_blockers(Color c) const;
+    Bitboard check_squares(PieceType piece_type) const;
+    Bitboard attacked_squares(Color c, Bitboard occupancy) const;
 
     // Move Generation
     void generate_quiet_promotions(MoveList& move_list, Color stm) const;
@@ -108,12 +167,21 @@ class Position {
     void generate_checker_capture_moves(MoveList& move_list, Color stm) const;
     void generate_quiet_moves(MoveList& move_list, Color stm) const;
     void generate_capture_moves(MoveList& move_list, Color stm) const;
+    void generate_legal_moves(MoveList& move_list, Color stm) const;
     MoveList check_evasion_move_list(Color stm) const;
     MoveList pseudo_legal_move_list(Color stm) const;
     MoveList legal_move_list(Color stm) const;
     MoveList check_evasion_move_list() const;
     MoveList pseudo_legal_move_list() const;
     MoveList legal_move_list() const;
+    int legal_move_count(Color stm) const;
+    int legal_move_count() const;
+    bool has_legal_move(Color stm) const;
+    bool has_legal_move() const;
+    template <GenType gen_type, Color::value_type c>
+    void generate(MoveList& move_list) const;
+    template <GenType gen_type>
+    void generate(MoveList& move_list) const;
 
     // Utilities
     void display_raw(std::ostream& ostream = std::cout) const;
@@ -121,12 +189,34 @@ class Position {
     std::string fen() const;
     std::string uci_line() const;
     void vflip();
+    void reserve_history(int plies);
+    void set_psqt(const PSQT* psqt);
+    void set_network(const nnue::Network* network);
     std::optional<Move> smallest_capture_move_to(Square square) const;
-    int see_to(Square square, std::array<int, 6> piece_values);
-    int see_for(Move move, std::array<int, 6> piece_values);
+    int see_to(Square square, std::array<int, 6> piece_values) const;
+    int see_for(Move move, std::array<int, 6> piece_values) const;
+    bool see_ge(Move move,
+                int threshold,
+                std::array<int, 6> piece_values = constants::SEE_PIECE_VALUES) const;
     static std::optional<Position> from_fen(const std::string& fen);
     static std::optional<Position> from_uci_position_line(const std::string& line);
 
+    // Recomputes the material key from the bitboards, for verifying material_key()
+    hash_type calculate_material_key() const {
+        hash_type key = 0;
+        for (Color c : constants::COLORS) {
+            for (PieceType pt : constants::PIECE_TYPES) {
+                int count = piece_type_bb(pt, c).popcount();
+                for (int i = 0; i < count; ++i) {
+                    key ^= zobrist::material_key(pt, c, i);
+                }
+            }
+        }
+        return key;
+    }
+
+    // Recomputes the key from scratch; hash() is maintained incrementally and this is meant for
+    // verifying it
     hash_type calculate_hash() const {
         hash_type hash_value = 0;
         for (Color c : constants::COLORS) {
@@ -139,13 +229,8 @@ class Position {
             }
         }
         auto ep_sq = enpassant_square();
-        if (ep_sq) {
-            Color stm = side_to_move();
-            Bitboard ep_candidates = piece_type_bb(constants::PAWN) & color_bb(stm) &
-                                     lookups::pawn_attacks(*ep_sq, !stm);
-            if (ep_candidates) {
-                hash_value ^= zobrist::enpassant_key(*ep_sq);
-            }
+        if (ep_sq && enpassant_capture_possible(*ep_sq, side_to_move())) {
+            hash_value ^= zobrist::enpassant_key(*ep_sq);
         }
         hash_value ^= zobrist::castling_rights_key(castling_rights());
         if (side_to_move() == constants::WHITE)
@@ -154,34 +239,75 @@ class Position {
     }
 
    protected:
-    // clang-format off
-    constexpr static int castling_spoilers[64] = {
-        13, 15, 15, 15, 12, 15, 15, 14,
-        15, 15, 15, 15, 15, 15, 15, 15,
-        15, 15, 15, 15, 15, 15, 15, 15,
-        15, 15, 15, 15, 15, 15, 15, 15,
-        15, 15, 15, 15, 15, 15, 15, 15,
-        15, 15, 15, 15, 15, 15, 15, 15,
-        15, 15, 15, 15, 15, 15, 15, 15,
-        7,  15, 15, 15, 3,  15, 15, 11
-    };
-    // clang-format on
+    // Sentinels for the packed State fields
+    constexpr static std::uint8_t NO_SQUARE = 64;
+    constexpr static std::uint8_t NO_PIECE_TYPE = 0xff;
 
+    // Packed into 32 bytes so that the history stays dense in cache. Absent values are encoded
+    // with the sentinels above, and a null previous_move_ stands for a null move or no move.
     struct State {
-        CastlingRights castling_rights_;
-        std::optional<Square> enpassant_square_;
-        std::optional<Move> previous_move_;
-        std::optional<PieceType> captured_pt_;
-        Move::Type move_type_ = Move::Type::NONE;
         hash_type hash_ = 0;
         hash_type pawn_hash_ = 0;
-        int halfmoves_ = 0;
+        Move previous_move_;
+        std::uint16_t halfmoves_ = 0;
+        std::uint8_t castling_rights_ = 0;
+        std::uint8_t enpassant_square_ = NO_SQUARE;
+        std::uint8_t captured_pt_ = NO_PIECE_TYPE;
+        Move::Type move_type_ = Move::Type::NONE;
+
+        CastlingRights castling_rights() const {
+            return CastlingRights{castling_rights_};
+        }
+        void set_castling_rights(CastlingRights castling_rights) {
+            castling_rights_ = std::uint8_t(castling_rights.value());
+        }
+        std::optional<Square> enpassant_square() const {
+            if (enpassant_square_ == NO_SQUARE) {
+                return std::nullopt;
+            }
+            return Square{enpassant_square_};
+        }
+        void set_enpassant_square(std::optional<Square> square) {
+            enpassant_square_ = square ? std::uint8_t(square->value()) : NO_SQUARE;
+        }
+        std::optional<Move> previous_move() const {
+            if (previous_move_ == Move{}) {
+                return std::nullopt;
+            }
+            return previous_move_;
+        }
+        std::optional<PieceType> captured_piece_type() const {
+            if (captured_pt_ == NO_PIECE_TYPE) {
+                return std::nullopt;
+            }
+            return PieceType{captured_pt_};
+        }
     };
+    static_assert(sizeof(State) <= 32);
 
+    // Check and pin information for the side to move. It is computed once per position and kept
+    // on its own stack beside the history, which stays compact for repetition scans, so that
+    // unmake_move only has to pop it.
+    struct CheckInfo {
+        Bitboard checkers_;
+        // Pieces of either color that alone stand between a slider and the king of each color
+        Bitboard king_blockers_[2];
+        // Squares from which a piece of each type of the side to move would give check
+        Bitboard check_squares_[6];
+    };
+
+   public:
+    // What make_move(Move, UndoInfo&) overwrites, for a caller to keep on its own per-ply stack
+    // and hand back to unmake_move(Move, const UndoInfo&)
+    struct UndoInfo {
+        CheckInfo check_info_;
+    };
+
+   protected:
     int ply() const {
         return ply_;
     }
-    const std::vector<State>& history() const {
+    const HistoryStack<State>& history() const {
         return history_;
     }
     State& state_mut_ref() {
@@ -196,6 +322,11 @@ class Position {
     const State& state(int ply) const {
         return history_[ply];
     }
+    // The top of the stack, which make_move(Move, UndoInfo&) overwrites rather than pushes
+    const CheckInfo& check_info() const {
+        return check_info_history_.back();
+    }
+    CheckInfo calculate_check_info() const;
     hash_type calculate_pawn_hash() const {
         hash_type hash_value = 0;
         for (Color c : constants::COLORS) {
@@ -208,32 +339,110 @@ class Position {
         return hash_value;
     }
 
+    bool enpassant_capture_possible(Square enpassant_square, Color c) const {
+        return piece_type_bb(constants::PAWN, c) & lookups::pawn_attacks(enpassant_square, !c);
+    }
+    void toggle_piece_keys(hash_type key, PieceType piece_type) {
+        State& curr_state = state_mut_ref();
+        curr_state.hash_ ^= key;
+        if (piece_type == constants::PAWN) {
+            curr_state.pawn_hash_ ^= key;
+        }
+    }
+
+    // Recomputes the piece counts, the material key and the PSQT sums from the bitboards
+    void refresh_material();
+    // Pushes the accumulator state of the move just made, recording the pieces it changed, and
+    // pops it again on unmake
+    void push_accumulator();
+    void pop_accumulator();
+    // Bring the top of the accumulator stack up to date for one perspective, incrementally from
+    // the last ply computed for it or from scratch; defined in NNUE.h, as they use the network
+    void update_accumulator(Color perspective) const;
+    void refresh_accumulator(Color perspective) const;
+
     void put_piece(Square square, PieceType piece_type, Color color) {
         Bitboard square_bb = Bitboard{square};
         piece_type_bb_[piece_type.value()] |= square_bb;
         color_bb_[color.value()] |= square_bb;
+        mailbox_[square] = Piece{piece_type, color}.value();
+        toggle_piece_keys(zobrist::piece_square_key(square, piece_type, color), piece_type);
+        std::uint8_t& count = piece_counts_[color.value()][piece_type.value()];
+        material_key_ ^= zobrist::material_key(piece_type, color, count);
+        ++count;
+        if (psqt_) {
+            psqt_mg_[color.value()] += psqt_->mg_value(square, piece_type, color);
+            psqt_eg_[color.value()] += psqt_->eg_value(square, piece_type, color);
+        }
     }
     void remove_piece(Square square, PieceType piece_type, Color color) {
         Bitboard square_bb = Bitboard{square};
         piece_type_bb_[piece_type.value()] &= ~square_bb;
         color_bb_[color.value()] &= ~square_bb;
+        mailbox_[square] = NO_PIECE;
+        toggle_piece_keys(zobrist::piece_square_key(square, piece_type, color), piece_type);
+        std::uint8_t& count = piece_counts_[color.value()][piece_type.value()];
+        --count;
+        material_key_ ^= zobrist::material_key(piece_type, color, count);
+        if (psqt_) {
+            psqt_mg_[color.value()] -= psqt_->mg_value(square, piece_type, color);
+            psqt_eg_[color.value()] -= psqt_->eg_value(square, piece_type, color);
+        }
     }
     void move_piece(Square from_square, Square to_square, PieceType piece_type, Color color) {
         Bitboard from_to_sqs_bb = Bitboard{from_square} ^ Bitboard { to_square };
         piece_type_bb_[piece_type.value()] ^= from_to_sqs_bb;
         color_bb_[color.value()] ^= from_to_sqs_bb;
+        mailbox_[to_square] = mailbox_[from_square];
+        mailbox_[from_square] = NO_PIECE;
+        toggle_piece_keys(zobrist::piece_square_key(from_square, piece_type, color) ^
+                              zobrist::piece_square_key(to_square, piece_type, color),
+                          piece_type);
+        if (psqt_) {
+            psqt_mg_[color.value()] += psqt_->mg_value(to_square, piece_type, color) -
+                                       psqt_->mg_value(from_square, piece_type, color);
+            psqt_eg_[color.value()] += psqt_->eg_value(to_square, piece_type, color) -
+                                       psqt_->eg_value(from_square, piece_type, color);
+        }
     }
+    template <GenType gen_type, Color::value_type c>
+    void generate_pawn_moves_to(MoveList& move_list, Bitboard targets) const;
+    template <GenType gen_type, Color::value_type c>
+    void generate_piece_moves_to(MoveList& move_list, Bitboard targets) const;
+    // Updates the board and fills next_state from prev_state; the piece keys are toggled on the
+    // current State, which next_state must be
+    void apply_move(Move move, const State& prev_state, State& next_state);
+    void unmake_piece_moves(Move move, Move::Type move_type, PieceType captured_pt);
+    // The hash and pawn hash make_move(move) would leave, as a pair
+    std::pair<hash_type, hash_type> hashes_after(Move move) const;
     void reverse_side_to_move() {
         side_to_move_ = !side_to_move_;
     }
 
    private:
+    // Mailbox entries hold Piece::value(), or NO_PIECE for an empty square
+    constexpr static std::uint8_t NO_PIECE = 0xff;
+
     Bitboard piece_type_bb_[6];
     Bitboard color_bb_[2];
+    std::array<std::uint8_t, 64> mailbox_;
+    // Material and PSQT sums are not part of State: unmake_move puts the pieces back through
+    // put_piece/remove_piece/move_piece, which restores them
+    std::uint8_t piece_counts_[2][6] = {};
+    hash_type material_key_ = 0;
+    const PSQT* psqt_ = nullptr;
+    int psqt_mg_[2] = {};
+    int psqt_eg_[2] = {};
+    const nnue::Network* network_ = nullptr;
+    // One entry per ply since set_network(), brought up to date lazily by evaluations. It starts
+    // with room for ACCUMULATOR_PLIES and grows with deeper lines, and is empty without a network,
+    // so copying a Position without a network copies no accumulators.
+    mutable HistoryStack<nnue::AccumulatorState> accumulators_;
     Color side_to_move_;
     int fullmoves_;
     int ply_;
-    std::vector<State> history_;
+    HistoryStack<State> history_;
+    HistoryStack<CheckInfo> check_info_history_;
 
     std::string start_fen_;
 };
@@ -246,4 +455,7 @@ class Position {
 #include "Position/MoveIntegration.h"
 #include "Position/Utilities.h"
 
+// Defines Network and the members above that use it
+#include "NNUE.h"
+
 #endif  // LIBCHESS_POSITION_H
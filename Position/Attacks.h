@@ -4,20 +4,14 @@
 namespace libchess {
 
 inline Bitboard Position::checkers_to(Color c) const {
+    if (c == side_to_move()) {
+        return check_info().checkers_;
+    }
     return attackers_to(king_square(c), !c);
 }
 
 inline Bitboard Position::attackers_to(Square square, Bitboard occupancy) const {
-    Bitboard attackers;
-    attackers |= lookups::pawn_attacks(square, constants::WHITE) &
-                 piece_type_bb(constants::PAWN, constants::BLACK);
-    attackers |= lookups::pawn_attacks(square, constants::BLACK) &
-                 piece_type_bb(constants::PAWN, constants::WHITE);
-    for (PieceType pt = constants::KNIGHT; pt <= constants::KING; ++pt) {
-        attackers |=
-            lookups::non_pawn_piece_type_attacks(pt, square, occupancy) & piece_type_bb(pt);
-    }
-    return attackers;
+    return movegen::attackers_to(*this, square, occupancy);
 }
 
 inline Bitboard Position::attackers_to(Square square) const {
@@ -46,21 +40,45 @@ inline Bitboard Position::attacks_of_piece_on(libchess::Square square) const {
 }
 
 inline Bitboard Position::pinned_pieces_of(Color c) const {
-    Bitboard pinned_bb;
-    Square king_sq = king_square(c);
-    Bitboard pinners_bb = ((piece_type_bb(constants::QUEEN) | piece_type_bb(constants::ROOK)) &
-                           color_bb(!c) & lookups::rook_attacks(king_sq)) |
-                          ((piece_type_bb(constants::QUEEN) | piece_type_bb(constants::BISHOP)) &
-                           color_bb(!c) & lookups::bishop_attacks(king_sq));
-    while (pinners_bb) {
-        Square sq = pinners_bb.forward_bitscan();
-        pinners_bb.forward_popbit();
-        Bitboard bb = lookups::intervening(sq, king_sq) & occupancy_bb();
-        if (bb.popcount() == 1) {
-            pinned_bb ^= bb & color_bb(c);
-        }
+    return check_info().king_blockers_[c] & color_bb(c);
+}
+
+inline Bitboard Position::king_blockers(Color c) const {
+    return check_info().king_blockers_[c];
+}
+
+inline Bitboard Position::check_squares(PieceType piece_type) const {
+    return check_info().check_squares_[piece_type.value()];
+}
+
+inline Position::CheckInfo Position::calculate_check_info() const {
+    CheckInfo info;
+    Color stm = side_to_move();
+    Bitboard occupancy = occupancy_bb();
+    for (Color c : constants::COLORS) {
+        info.king_blockers_[c] = movegen::king_blockers(*this, c);
+    }
+
+    Bitboard stm_king_bb = piece_type_bb(constants::KING, stm);
+    if (stm_king_bb) {
+        info.checkers_ = attackers_to(stm_king_bb.forward_bitscan(), !stm);
     }
-    return pinned_bb;
+    Bitboard opp_king_bb = piece_type_bb(constants::KING, !stm);
+    if (opp_king_bb) {
+        Square king_sq = opp_king_bb.forward_bitscan();
+        Bitboard bishop_checks = lookups::bishop_attacks(king_sq, occupancy);
+        Bitboard rook_checks = lookups::rook_attacks(king_sq, occupancy);
+        info.check_squares_[constants::PAWN.value()] = lookups::pawn_attacks(king_sq, !stm);
+        info.check_squares_[constants::KNIGHT.value()] = lookups::knight_attacks(king_sq);
+        info.check_squares_[constants::BISHOP.value()] = bishop_checks;
+        info.check_squares_[constants::ROOK.value()] = rook_checks;
+        info.check_squares_[constants::QUEEN.value()] = bishop_checks | rook_checks;
+    }
+    return info;
+}
+
+inline Bitboard Position::attacked_squares(Color c, Bitboard occupancy) const {
+    return movegen::attacked_squares(*this, c, occupancy);
 }
 
 }  // namespace libchess
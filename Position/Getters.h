@@ -24,11 +24,11 @@ inline Color Position::side_to_move() const {
 }
 
 inline CastlingRights Position::castling_rights() const {
-    return history_[ply_].castling_rights_;
+    return history_[ply_].castling_rights();
 }
 
 inline std::optional<Square> Position::enpassant_square() const {
-    return history_[ply_].enpassant_square_;
+    return history_[ply_].enpassant_square();
 }
 
 inline int Position::halfmoves() const {
@@ -40,11 +40,11 @@ inline int Position::fullmoves() const {
 }
 
 inline std::optional<Move> Position::previous_move() const {
-    return history_[ply_].previous_move_;
+    return history_[ply_].previous_move();
 }
 
 inline std::optional<PieceType> Position::previously_captured_piece() const {
-    return history_[ply_].captured_pt_;
+    return history_[ply_].captured_piece_type();
 }
 
 inline Position::hash_type Position::hash() const {
@@ -55,30 +55,58 @@ inline Position::hash_type Position::pawn_hash() const {
     return history_[ply_].pawn_hash_;
 }
 
+inline Position::hash_type Position::material_key() const {
+    return material_key_;
+}
+
+inline int Position::piece_count(PieceType piece_type, Color color) const {
+    return piece_counts_[color.value()][piece_type.value()];
+}
+
+inline const PSQT* Position::psqt() const {
+    return psqt_;
+}
+
+// Sum of the PSQT mid-game values of the pieces of color, or 0 without a table
+inline int Position::psqt_mg(Color color) const {
+    return psqt_mg_[color.value()];
+}
+
+// Sum of the PSQT end-game values of the pieces of color, or 0 without a table
+inline int Position::psqt_eg(Color color) const {
+    return psqt_eg_[color.value()];
+}
+
+inline const nnue::Network* Position::network() const {
+    return network_;
+}
+
 inline Square Position::king_square(Color color) const {
     return piece_type_bb(constants::KING, color).forward_bitscan();
 }
 
 inline std::optional<PieceType> Position::piece_type_on(Square square) const {
-    for (PieceType piece_type : constants::PIECE_TYPES) {
-        if (piece_type_bb(piece_type) & Bitboard{square}) {
-            return piece_type;
-        }
+    std::uint8_t piece_value = mailbox_[square];
+    if (piece_value == NO_PIECE) {
+        return std::nullopt;
     }
-    return std::nullopt;
+    return Piece{piece_value}.type();
 }
 
 inline std::optional<Color> Position::color_of(Square square) const {
-    for (Color c : constants::COLORS) {
-        if (color_bb(c) & Bitboard{square}) {
-            return c;
-        }
+    std::uint8_t piece_value = mailbox_[square];
+    if (piece_value == NO_PIECE) {
+        return std::nullopt;
     }
-    return std::nullopt;
+    return Piece{piece_value}.color();
 }
 
 inline std::optional<Piece> Position::piece_on(Square square) const {
-    return Piece::from(piece_type_on(square), color_of(square));
+    std::uint8_t piece_value = mailbox_[square];
+    if (piece_value == NO_PIECE) {
+        return std::nullopt;
+    }
+    return Piece{piece_value};
 }
 
 inline bool Position::in_check() const {
@@ -112,6 +140,71 @@ inline int Position::repeat_count() const {
     return count;
 }
 
+// Whether the side to move has a reversible move, legal or not, that returns to a position from
+// earlier in the game, found by probing the cuckoo table with each candidate key difference.
+// ply is the distance from the search root: a cycle that closes within the search counts as a
+// draw at once, one reaching back to before the root only if that position already repeated.
+inline bool Position::has_game_cycle(int ply) const {
+    int end = std::min(halfmoves(), ply_);
+    if (end < 3 || state().move_type_ == Move::Type::NONE) {
+        return false;
+    }
+    hash_type curr_hash = hash();
+    Bitboard occupancy = occupancy_bb();
+    int num_keys = std::max(0, ply_ - halfmoves());
+    for (int i = 3; i <= end; i += 2) {
+        // A null move breaks the chain of moves that could be undone
+        if (state(ply_ - i + 2).move_type_ == Move::Type::NONE ||
+            state(ply_ - i + 1).move_type_ == Move::Type::NONE) {
+            return false;
+        }
+        auto move = cuckoo::probe(curr_hash ^ state(ply_ - i).hash_);
+        if (!move) {
+            continue;
+        }
+        Square from = move->from_square();
+        Square to = move->to_square();
+        if (lookups::intervening(from, to) & occupancy) {
+            continue;
+        }
+        if (ply > i) {
+            return true;
+        }
+        // Both directions of a move share an entry, so the piece making it is whichever of the
+        // two squares is occupied
+        if (color_of(piece_on(from) ? from : to) != side_to_move()) {
+            continue;
+        }
+        hash_type cycle_hash = state(ply_ - i).hash_;
+        for (int j = ply_ - i - 2; j >= num_keys; j -= 2) {
+            if (state(j).hash_ == cycle_hash) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+// Snapshot of the current position for copy-make; see Board
+inline Board Position::board() const {
+    Board board;
+    for (PieceType pt : constants::PIECE_TYPES) {
+        board.piece_type_bb_[pt.value()] = piece_type_bb(pt);
+    }
+    for (Color c : constants::COLORS) {
+        board.color_bb_[c.value()] = color_bb(c);
+    }
+    board.checkers_ = check_info().checkers_;
+    board.hash_ = hash();
+    board.pawn_hash_ = pawn_hash();
+    board.halfmoves_ = std::uint16_t(halfmoves());
+    board.fullmoves_ = std::uint16_t(fullmoves());
+    board.side_to_move_ = std::uint8_t(side_to_move().value());
+    board.castling_rights_ = std::uint8_t(castling_rights().value());
+    board.enpassant_square_ = state().enpassant_square_;
+    return board;
+}
+
 inline const std::string& Position::start_fen() const {
     return start_fen_;
 }
@@ -121,13 +214,9 @@ inline Position::GameState Position::game_state() const {
         return GameState::THREEFOLD_REPETITION;
     } else if (halfmoves() >= 100) {
         return GameState::FIFTY_MOVES;
+    } else if (!has_legal_move()) {
+        return in_check() ? GameState::CHECKMATE : GameState::STALEMATE;
     } else {
-        MoveList move_list = legal_move_list();
-
-        if (move_list.empty()) {
-            return in_check() ? GameState::CHECKMATE : GameState::STALEMATE;
-        }
-
         return GameState::IN_PROGRESS;
     }
 }
@@ -154,77 +243,11 @@ inline bool Position::is_legal_generated_move(Move move) const {
     }
 }
 
+// Validates an arbitrary move, such as a TT move or a killer, in constant time, with the same
+// check and pin masks as generate_legal_moves()
 inline bool Position::is_legal_move(Move move) const {
-    Square from_sq = move.from_square();
-    auto piece_opt = piece_on(from_sq);
-    if (!piece_opt) {
-        return false;
-    }
-
-    Piece piece = *piece_opt;
-    Color c = piece.color();
-    if (c != side_to_move()) {
-        return false;
-    }
-
-    Square to_sq = move.to_square();
-    if (color_of(to_sq) == c) {
-        return false;
-    }
-
-    PieceType pt = piece.type();
-    if (move.promotion_piece_type()) {
-        if (pt != constants::PAWN) {
-            return false;
-        }
-
-        if (lookups::relative_rank(to_sq.rank(), c) != constants::RANK_8) {
-            return false;
-        }
-    }
-
-    bool is_pseudo_legal = false;
-    if (pt == constants::KING) {
-        MoveList castling_move_list;
-        generate_castling(castling_move_list, c);
-        if (castling_move_list.contains(move)) {
-            is_pseudo_legal = true;
-        }
-    }
-
-    if (!is_pseudo_legal) {
-        auto ep_sq = enpassant_square();
-        Bitboard to_sq_bb{to_sq};
-        Bitboard opponent_occupancy = color_bb(!c);
-        Bitboard stm_occupancy = color_bb(c);
-        Bitboard occupancy = stm_occupancy | opponent_occupancy;
-        if (pt == constants::PAWN) {
-            if (to_sq == lookups::pawn_shift(from_sq, c) && !(occupancy & to_sq_bb)) {
-                is_pseudo_legal = true;
-            } else if (to_sq == lookups::pawn_shift(from_sq, c, 2) &&
-                       !(occupancy & (to_sq_bb | lookups::pawn_shift(to_sq_bb, !c)))) {
-                is_pseudo_legal = true;
-            } else if (ep_sq && to_sq == *ep_sq &&
-                       (lookups::pawn_attacks(from_sq, c) & Bitboard{*ep_sq})) {
-                is_pseudo_legal = true;
-            } else if (to_sq_bb & lookups::pawn_attacks(from_sq, c) & opponent_occupancy) {
-                is_pseudo_legal = true;
-            }
-        } else if (to_sq_bb & lookups::non_pawn_piece_type_attacks(pt, from_sq, occupancy) &
-                   ~stm_occupancy) {
-            is_pseudo_legal = true;
-        }
-    }
-
-    if (!is_pseudo_legal) {
-        return false;
-    }
-    if (!in_check()) {
-        return is_legal_generated_move(move);
-    }
-
-    MoveList move_list = legal_move_list();
-    return move_list.contains(move);
+    Color c = side_to_move();
+    return movegen::is_legal_move(*this, move, checkers_to(c), pinned_pieces_of(c));
 }
 
 }  // namespace libchess
@@ -348,19 +348,13 @@ inline MoveList Position::pseudo_legal_move_list() const {
     return pseudo_legal_move_list(side_to_move());
 }
 
+inline void Position::generate_legal_moves(MoveList& move_list, Color stm) const {
+    movegen::generate_legal_moves(*this, move_list, stm, checkers_to(stm), pinned_pieces_of(stm));
+}
+
 inline MoveList Position::legal_move_list(Color stm) const {
-    MoveList move_list = checkers_to(stm) ? check_evasion_move_list() : pseudo_legal_move_list();
-    Bitboard pinned = pinned_pieces_of(stm);
-    for (auto move = move_list.begin(); move != move_list.end();) {
-        if (((pinned & Bitboard{move->from_square()}) || move->from_square() == king_square(stm) ||
-             move->type() == Move::Type::ENPASSANT) &&
-            !is_legal_generated_move(*move)) {
-            *move = *(move_list.end() - 1);
-            move_list.pop_back();
-        } else {
-            ++move;
-        }
-    }
+    MoveList move_list;
+    generate_legal_moves(move_list, stm);
     return move_list;
 }
 
@@ -371,6 +365,260 @@ inline MoveList Position::legal_move_list() const {
     return legal_move_list(side_to_move());
 }
 
+inline int Position::legal_move_count(Color stm) const {
+    return movegen::legal_move_count(*this, stm, checkers_to(stm), pinned_pieces_of(stm));
+}
+
+inline int Position::legal_move_count() const {
+    if (halfmoves() >= 150 || is_repeat(4)) {
+        return 0;
+    }
+    return legal_move_count(side_to_move());
+}
+
+inline bool Position::has_legal_move(Color stm) const {
+    return movegen::has_legal_move(*this, stm, checkers_to(stm), pinned_pieces_of(stm));
+}
+
+inline bool Position::has_legal_move() const {
+    return has_legal_move(side_to_move());
+}
+
+
+// Pawn moves of color c whose destination is in targets: pushes onto empty squares and captures
+// of enemy pieces, which for evasions leaves only blocks and captures of the checker
+template <Position::GenType gen_type, Color::value_type c>
+inline void Position::generate_pawn_moves_to(MoveList& move_list, Bitboard targets) const {
+    constexpr Color us{c};
+    constexpr Color them = !us;
+    constexpr int up = us == constants::WHITE ? 8 : -8;
+    constexpr int up_west = up - 1;
+    constexpr int up_east = up + 1;
+
+    auto add_moves = [&move_list](Bitboard to_bb, int delta, Move::Type type) {
+        while (to_bb) {
+            Square to_sq = to_bb.forward_bitscan();
+            to_bb.forward_popbit();
+            move_list.add(Move{to_sq - delta, to_sq, type});
+        }
+    };
+    auto add_promotions = [&move_list](Bitboard to_bb, int delta, Move::Type type) {
+        while (to_bb) {
+            Square to_sq = to_bb.forward_bitscan();
+            to_bb.forward_popbit();
+            Square from_sq = to_sq - delta;
+            move_list.add(Move{from_sq, to_sq, constants::QUEEN, type});
+            move_list.add(Move{from_sq, to_sq, constants::KNIGHT, type});
+            move_list.add(Move{from_sq, to_sq, constants::ROOK, type});
+            move_list.add(Move{from_sq, to_sq, constants::BISHOP, type});
+        }
+    };
+
+    Bitboard rank7_mask = lookups::relative_rank_mask(constants::RANK_7, us);
+    Bitboard pawn_bb = piece_type_bb(constants::PAWN, us);
+    Bitboard promoting_pawns = pawn_bb & rank7_mask;
+    Bitboard other_pawns = pawn_bb & ~rank7_mask;
+    Bitboard empty = ~occupancy_bb();
+    Bitboard enemies = color_bb(them) & targets;
+
+    if constexpr (gen_type != GenType::CAPTURES) {
+        Bitboard single_pushes = lookups::pawn_shift(other_pawns, us) & empty;
+        Bitboard double_pushes =
+            lookups::pawn_shift(single_pushes & lookups::relative_rank_mask(constants::RANK_3, us),
+                                us) &
+            empty;
+        single_pushes &= targets;
+        double_pushes &= targets;
+        if constexpr (gen_type == GenType::QUIET_CHECKS) {
+            // Pushes onto a pawn check square, or off the line between a slider and the king
+            Bitboard discovered = other_pawns & king_blockers(them) &
+                                  ~lookups::FILE_MASK[king_square(them).file()];
+            single_pushes &= check_squares(constants::PAWN) | lookups::pawn_shift(discovered, us);
+            double_pushes &=
+                check_squares(constants::PAWN) | lookups::pawn_shift(discovered, us, 2);
+        }
+        add_moves(double_pushes, 2 * up, Move::Type::DOUBLE_PUSH);
+        add_moves(single_pushes, up, Move::Type::NORMAL);
+    }
+
+    if constexpr (gen_type == GenType::QUIET_CHECKS) {
+        // Promotions are rare enough to test one by one
+        Bitboard pushes = lookups::pawn_shift(promoting_pawns, us) & empty;
+        while (pushes) {
+            Square to_sq = pushes.forward_bitscan();
+            pushes.forward_popbit();
+            for (PieceType pt : {constants::QUEEN, constants::KNIGHT, constants::ROOK,
+                                 constants::BISHOP}) {
+                Move move{to_sq - up, to_sq, pt, Move::Type::PROMOTION};
+                if (gives_check(move)) {
+                    move_list.add(move);
+                }
+            }
+        }
+        return;
+    }
+
+    if (promoting_pawns) {
+        if constexpr (gen_type != GenType::CAPTURES) {
+            Bitboard pushes = lookups::pawn_shift(promoting_pawns, us) & empty & targets;
+            add_promotions(pushes, up, Move::Type::PROMOTION);
+        }
+        if constexpr (gen_type != GenType::QUIETS) {
+            Bitboard west = lookups::pawn_shift(promoting_pawns & ~lookups::FILE_A_MASK, us) >> 1;
+            Bitboard east = lookups::pawn_shift(promoting_pawns & ~lookups::FILE_H_MASK, us) << 1;
+            add_promotions(west & enemies, up_west, Move::Type::CAPTURE_PROMOTION);
+            add_promotions(east & enemies, up_east, Move::Type::CAPTURE_PROMOTION);
+        }
+    }
+
+    if constexpr (gen_type != GenType::QUIETS) {
+        Bitboard west = lookups::pawn_shift(other_pawns & ~lookups::FILE_A_MASK, us) >> 1;
+        Bitboard east = lookups::pawn_shift(other_pawns & ~lookups::FILE_H_MASK, us) << 1;
+        add_moves(west & enemies, up_west, Move::Type::CAPTURE);
+        add_moves(east & enemies, up_east, Move::Type::CAPTURE);
+
+        // Only the pawn that just moved can be giving check, so an evasion has to capture it
+        auto ep_sq = enpassant_square();
+        if (ep_sq && (gen_type != GenType::EVASIONS ||
+                      (lookups::pawn_shift(Bitboard{*ep_sq}, them) & checkers_to(us)))) {
+            Bitboard ep_candidates = other_pawns & lookups::pawn_attacks(*ep_sq, them);
+            while (ep_candidates) {
+                Square from_sq = ep_candidates.forward_bitscan();
+                ep_candidates.forward_popbit();
+                move_list.add(Move{from_sq, *ep_sq, Move::Type::ENPASSANT});
+            }
+        }
+    }
+}
+
+// Knight, bishop, rook and queen moves of color c whose destination is in targets
+template <Position::GenType gen_type, Color::value_type c>
+inline void Position::generate_piece_moves_to(MoveList& move_list, Bitboard targets) const {
+    constexpr Color us{c};
+    Bitboard occupancy = occupancy_bb();
+    Bitboard enemies = color_bb(!us);
+    Bitboard discovered;
+    Square opp_king_sq{0};
+    if constexpr (gen_type == GenType::QUIET_CHECKS) {
+        discovered = king_blockers(!us) & color_bb(us);
+        opp_king_sq = king_square(!us);
+    }
+    for (PieceType pt = constants::KNIGHT; pt <= constants::QUEEN; ++pt) {
+        Bitboard piece_bb = piece_type_bb(pt, us);
+        while (piece_bb) {
+            Square from_sq = piece_bb.forward_bitscan();
+            piece_bb.forward_popbit();
+            Bitboard to_bb = lookups::non_pawn_piece_type_attacks(pt, from_sq, occupancy) & targets;
+            if constexpr (gen_type == GenType::QUIET_CHECKS) {
+                Bitboard check_targets = check_squares(pt);
+                if (discovered & Bitboard{from_sq}) {
+                    check_targets |= ~lookups::full_ray(opp_king_sq, from_sq);
+                }
+                to_bb &= check_targets;
+            }
+            while (to_bb) {
+                Square to_sq = to_bb.forward_bitscan();
+                to_bb.forward_popbit();
+                Move::Type type = Move::Type::NORMAL;
+                if constexpr (gen_type == GenType::CAPTURES) {
+                    type = Move::Type::CAPTURE;
+                } else if constexpr (gen_type == GenType::EVASIONS ||
+                                     gen_type == GenType::NON_EVASIONS) {
+                    type = (enemies & Bitboard{to_sq}) ? Move::Type::CAPTURE : Move::Type::NORMAL;
+                }
+                move_list.add(Move{from_sq, to_sq, type});
+            }
+        }
+    }
+}
+
+// Appends the moves of color c in the gen_type category with the side and the category fixed at
+// compile time. QUIET_CHECKS and LEGAL rely on the cached check info and so need c to be the side
+// to move; EVASIONS requires c to be in check and QUIET_CHECKS and NON_EVASIONS not.
+template <Position::GenType gen_type, Color::value_type c>
+inline void Position::generate(MoveList& move_list) const {
+    constexpr Color us{c};
+    constexpr Color them = !us;
+    Square king_sq = king_square(us);
+
+    if constexpr (gen_type == GenType::LEGAL) {
+        // Check evasions and pins are masked out while generating rather than filtered after
+        assert(us == side_to_move());
+        generate_legal_moves(move_list, us);
+        return;
+    } else {
+        assert(gen_type != GenType::QUIET_CHECKS || us == side_to_move());
+        assert((gen_type == GenType::EVASIONS) == bool(checkers_to(us)) ||
+               gen_type == GenType::CAPTURES || gen_type == GenType::QUIETS);
+
+        Bitboard occupancy = occupancy_bb();
+        Bitboard king_targets = lookups::king_attacks(king_sq) & ~color_bb(us);
+        Bitboard targets;
+        if constexpr (gen_type == GenType::EVASIONS) {
+            // The king is left out of the occupancy so that it cannot step back along a checking
+            // ray
+            king_targets &= ~attacked_squares(them, occupancy ^ Bitboard{king_sq});
+            // In double check only the king can move, which the empty targets ensure
+            Bitboard checkers = checkers_to(us);
+            if (checkers.popcount() == 1) {
+                targets = checkers | lookups::intervening(king_sq, checkers.forward_bitscan());
+            }
+        } else if constexpr (gen_type == GenType::CAPTURES) {
+            targets = color_bb(them);
+        } else if constexpr (gen_type == GenType::QUIETS || gen_type == GenType::QUIET_CHECKS) {
+            targets = ~occupancy;
+        } else {
+            targets = ~color_bb(us);
+        }
+
+        if (targets) {
+            generate_pawn_moves_to<gen_type, c>(move_list, targets);
+            generate_piece_moves_to<gen_type, c>(move_list, targets);
+        }
+
+        if constexpr (gen_type == GenType::QUIET_CHECKS) {
+            // The king never checks directly, but can uncover a slider by leaving its line
+            king_targets = Bitboard{};
+            if (king_blockers(them) & Bitboard{king_sq}) {
+                king_targets = lookups::king_attacks(king_sq) & targets &
+                               ~lookups::full_ray(king_square(them), king_sq);
+            }
+        } else if constexpr (gen_type != GenType::EVASIONS) {
+            king_targets &= targets;
+        }
+        Bitboard enemies = color_bb(them);
+        while (king_targets) {
+            Square to_sq = king_targets.forward_bitscan();
+            king_targets.forward_popbit();
+            move_list.add(Move{king_sq,
+                               to_sq,
+                               (enemies & Bitboard{to_sq}) ? Move::Type::CAPTURE
+                                                           : Move::Type::NORMAL});
+        }
+
+        if constexpr (gen_type == GenType::QUIETS || gen_type == GenType::NON_EVASIONS) {
+            generate_castling(move_list, us);
+        } else if constexpr (gen_type == GenType::QUIET_CHECKS) {
+            MoveList castling_moves;
+            generate_castling(castling_moves, us);
+            for (Move move : castling_moves) {
+                if (gives_check(move)) {
+                    move_list.add(move);
+                }
+            }
+        }
+    }
+}
+
+template <Position::GenType gen_type>
+inline void Position::generate(MoveList& move_list) const {
+    if (side_to_move() == constants::WHITE) {
+        generate<gen_type, Color::Value::WHITE>(move_list);
+    } else {
+        generate<gen_type, Color::Value::BLACK>(move_list);
+    }
+}
+
 }  // namespace libchess
 
 #endif  // LIBCHESS_MOVEGENERATION_H
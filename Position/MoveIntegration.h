@@ -4,76 +4,147 @@
 namespace libchess {
 
 inline Move::Type Position::move_type_of(Move move) const {
-    Move::Type move_type = move.type();
-    if (move_type != Move::Type::NONE) {
-        return move_type;
-    } else {
-        Square to_square = move.to_square();
-        Square from_square = move.from_square();
-        auto moving_pt = piece_type_on(from_square);
-        auto captured_pt = piece_type_on(to_square);
-        auto promotion_pt = move.promotion_piece_type();
-        if (promotion_pt) {
-            return captured_pt ? Move::Type::CAPTURE_PROMOTION : Move::Type::PROMOTION;
-        } else if (captured_pt) {
-            return Move::Type::CAPTURE;
-        } else if (moving_pt == constants::PAWN) {
-            int sq_diff = std::abs(to_square - from_square);
-            if (sq_diff == 16) {
-                return Move::Type::DOUBLE_PUSH;
-            } else if (sq_diff == 9 || sq_diff == 7) {
-                return Move::Type::ENPASSANT;
-            } else {
-                return Move::Type::NORMAL;
-            }
-        } else if (moving_pt == constants::KING && std::abs(to_square - from_square) == 2) {
-            return Move::Type::CASTLING;
-        } else {
-            return Move::Type::NORMAL;
-        }
-    }
+    return movegen::move_type_of(*this, move);
 }
 
 inline bool Position::is_capture_move(Move move) const {
+    return movegen::is_capture_move(move);
+}
+
+inline bool Position::is_promotion_move(Move move) const {
     Move::Type move_type = move.type();
     switch (move_type) {
-        case Move::Type::CAPTURE:
+        case Move::Type::PROMOTION:
         case Move::Type::CAPTURE_PROMOTION:
-        case Move::Type::ENPASSANT:
             return true;
         default:
             return false;
     }
 }
 
-inline bool Position::is_promotion_move(Move move) const {
-    Move::Type move_type = move.type();
-    switch (move_type) {
+// Whether a pseudo-legal move of the side to move checks the opposing king, decided from the cached
+// check squares and king blockers without making the move
+inline bool Position::gives_check(Move move) const {
+    Color stm = side_to_move();
+    PieceType pt = *piece_type_on(move.from_square());
+    return movegen::gives_check(
+        *this, move, check_squares(pt), king_blockers(!stm) & color_bb(stm));
+}
+
+inline std::pair<Position::hash_type, Position::hash_type> Position::hashes_after(
+    Move move) const {
+    Color stm = side_to_move();
+    Square from_square = move.from_square();
+    Square to_square = move.to_square();
+    hash_type hash_value = hash() ^ zobrist::side_to_move_key();
+    hash_type pawn_hash_value = pawn_hash();
+    auto toggle = [&](Square square, PieceType piece_type, Color color) {
+        hash_type key = zobrist::piece_square_key(square, piece_type, color);
+        hash_value ^= key;
+        if (piece_type == constants::PAWN) {
+            pawn_hash_value ^= key;
+        }
+    };
+
+    auto ep_sq = enpassant_square();
+    if (ep_sq && enpassant_capture_possible(*ep_sq, stm)) {
+        hash_value ^= zobrist::enpassant_key(*ep_sq);
+    }
+    CastlingRights curr_castling_rights = castling_rights();
+    CastlingRights next_castling_rights{curr_castling_rights.value() &
+                                        lookups::castling_spoilers(from_square) &
+                                        lookups::castling_spoilers(to_square)};
+    if (!(next_castling_rights == curr_castling_rights)) {
+        hash_value ^= zobrist::castling_rights_key(curr_castling_rights) ^
+                      zobrist::castling_rights_key(next_castling_rights);
+    }
+
+    PieceType moving_pt = piece_type_on(from_square).value_or(constants::PAWN);
+    switch (move_type_of(move)) {
+        case Move::Type::NORMAL:
+            toggle(from_square, moving_pt, stm);
+            toggle(to_square, moving_pt, stm);
+            break;
+        case Move::Type::CAPTURE:
+            toggle(to_square, *piece_type_on(to_square), !stm);
+            toggle(from_square, moving_pt, stm);
+            toggle(to_square, moving_pt, stm);
+            break;
+        case Move::Type::DOUBLE_PUSH: {
+            toggle(from_square, constants::PAWN, stm);
+            toggle(to_square, constants::PAWN, stm);
+            Square next_ep_sq = lookups::pawn_shift(from_square, stm);
+            if (enpassant_capture_possible(next_ep_sq, !stm)) {
+                hash_value ^= zobrist::enpassant_key(next_ep_sq);
+            }
+            break;
+        }
+        case Move::Type::ENPASSANT:
+            toggle(from_square, constants::PAWN, stm);
+            toggle(to_square, constants::PAWN, stm);
+            toggle(lookups::pawn_shift(to_square, !stm), constants::PAWN, !stm);
+            break;
+        case Move::Type::CASTLING: {
+            toggle(from_square, constants::KING, stm);
+            toggle(to_square, constants::KING, stm);
+            bool kingside = to_square > from_square;
+            toggle(kingside ? from_square + 3 : from_square - 4, constants::ROOK, stm);
+            toggle(kingside ? from_square + 1 : from_square - 1, constants::ROOK, stm);
+            break;
+        }
         case Move::Type::PROMOTION:
+            toggle(from_square, constants::PAWN, stm);
+            toggle(to_square, *move.promotion_piece_type(), stm);
+            break;
         case Move::Type::CAPTURE_PROMOTION:
-            return true;
-        default:
-            return false;
+            toggle(to_square, *piece_type_on(to_square), !stm);
+            toggle(from_square, constants::PAWN, stm);
+            toggle(to_square, *move.promotion_piece_type(), stm);
+            break;
+        case Move::Type::NONE:
+            break;
     }
+    return {hash_value, pawn_hash_value};
+}
+
+// Predicts hash() after make_move(move) without making it, e.g. to prefetch the child's TT entry
+inline Position::hash_type Position::hash_after(Move move) const {
+    return hashes_after(move).first;
+}
+
+inline Position::hash_type Position::pawn_hash_after(Move move) const {
+    return hashes_after(move).second;
 }
 
 inline void Position::unmake_move() {
-    auto move = state().previous_move_;
+    const State& curr_state = state();
+    Move move = curr_state.previous_move_;
+    Move::Type move_type = curr_state.move_type_;
+    PieceType captured_pt{curr_state.captured_pt_};
     if (side_to_move() == constants::WHITE) {
         --fullmoves_;
     }
-    Move::Type move_type = state().move_type_;
-    auto captured_pt = state().captured_pt_;
+    reverse_side_to_move();
+    if (move_type != Move::Type::NONE) {
+        // The pieces are put back before the state is popped so that the key updates in
+        // put_piece/remove_piece/move_piece land on the discarded state
+        unmake_piece_moves(move, move_type, captured_pt);
+    }
     --ply_;
     history_.pop_back();
-    reverse_side_to_move();
-    if (!move) {
-        return;
+    check_info_history_.pop_back();
+    if (network_) {
+        pop_accumulator();
     }
+}
+
+inline void Position::unmake_piece_moves(Move move,
+                                         Move::Type move_type,
+                                         PieceType captured_pt) {
     Color stm = side_to_move();
 
-    Square from_square = move->from_square();
-    Square to_square = move->to_square();
+    Square from_square = move.from_square();
+    Square to_square = move.to_square();
 
     auto moving_pt = piece_type_on(to_square);
     switch (move_type) {
@@ -82,7 +153,7 @@ inline void Position::unmake_move() {
             break;
         case Move::Type::CAPTURE:
             move_piece(to_square, from_square, *moving_pt, stm);
-            put_piece(to_square, *captured_pt, !stm);
+            put_piece(to_square, captured_pt, !stm);
             break;
         case Move::Type::DOUBLE_PUSH:
             move_piece(to_square, from_square, constants::PAWN, stm);
@@ -113,13 +184,13 @@ inline void Position::unmake_move() {
             }
             break;
         case Move::Type::PROMOTION:
-            remove_piece(to_square, *move->promotion_piece_type(), stm);
+            remove_piece(to_square, *move.promotion_piece_type(), stm);
             put_piece(from_square, constants::PAWN, stm);
             break;
         case Move::Type::CAPTURE_PROMOTION:
-            remove_piece(to_square, *move->promotion_piece_type(), stm);
+            remove_piece(to_square, *move.promotion_piece_type(), stm);
             put_piece(from_square, constants::PAWN, stm);
-            put_piece(to_square, *captured_pt, !stm);
+            put_piece(to_square, captured_pt, !stm);
             break;
         case Move::Type::NONE:
             break;
@@ -127,24 +198,75 @@ inline void Position::unmake_move() {
 }
 
 inline void Position::make_move(Move move) {
+    ++ply_;
+    history_.push_back(State{});
+    apply_move(move, state(ply_ - 1), state_mut_ref());
+    check_info_history_.push_back(calculate_check_info());
+    if (network_) {
+        push_accumulator();
+    }
+    assert(hash() == calculate_hash());
+    assert(pawn_hash() == calculate_pawn_hash());
+}
+
+// The State is pushed as by make_move(Move), so repetition and cycle checks see the move, and so
+// is the accumulator state with a network; the CheckInfo, the bulk of a ply, is saved to undo and
+// overwritten in place instead. Undo the move with unmake_move(Move, const UndoInfo&).
+inline void Position::make_move(Move move, UndoInfo& undo) {
+    undo.check_info_ = check_info();
+    ++ply_;
+    history_.push_back(State{});
+    apply_move(move, state(ply_ - 1), state_mut_ref());
+    check_info_history_.back() = calculate_check_info();
+    if (network_) {
+        push_accumulator();
+    }
+    assert(hash() == calculate_hash());
+    assert(pawn_hash() == calculate_pawn_hash());
+}
+
+inline void Position::unmake_move(Move move, const UndoInfo& undo) {
+    const State& curr_state = state();
+    assert(curr_state.previous_move_ == move);
+    if (side_to_move() == constants::WHITE) {
+        --fullmoves_;
+    }
+    reverse_side_to_move();
+    if (curr_state.move_type_ != Move::Type::NONE) {
+        unmake_piece_moves(move, curr_state.move_type_, PieceType{curr_state.captured_pt_});
+    }
+    --ply_;
+    history_.pop_back();
+    check_info_history_.back() = undo.check_info_;
+    if (network_) {
+        pop_accumulator();
+    }
+}
+
+inline void Position::apply_move(Move move, const State& prev_state, State& next_state) {
     Color stm = side_to_move();
     if (stm == constants::BLACK) {
         ++fullmoves_;
     }
-    ++ply_;
-    history_.push_back(State{});
-    State& prev_state = state_mut_ref(ply_ - 1);
-    State& next_state = state_mut_ref();
     next_state.halfmoves_ = prev_state.halfmoves_ + 1;
     next_state.previous_move_ = move;
-    next_state.enpassant_square_ = {};
+    next_state.hash_ = prev_state.hash_ ^ zobrist::side_to_move_key();
+    next_state.pawn_hash_ = prev_state.pawn_hash_;
+    auto prev_ep_sq = prev_state.enpassant_square();
+    if (prev_ep_sq && enpassant_capture_possible(*prev_ep_sq, stm)) {
+        next_state.hash_ ^= zobrist::enpassant_key(*prev_ep_sq);
+    }
 
     Square from_square = move.from_square();
     Square to_square = move.to_square();
 
-    next_state.castling_rights_ = CastlingRights{prev_state.castling_rights_.value() &
-                                                 castling_spoilers[from_square.value()] &
-                                                 castling_spoilers[to_square.value()]};
+    next_state.castling_rights_ = prev_state.castling_rights_ &
+                                  lookups::castling_spoilers(from_square) &
+                                  lookups::castling_spoilers(to_square);
+    if (next_state.castling_rights_ != prev_state.castling_rights_) {
+        next_state.hash_ ^= zobrist::castling_rights_key(prev_state.castling_rights()) ^
+                            zobrist::castling_rights_key(next_state.castling_rights());
+    }
 
     auto moving_pt = piece_type_on(from_square);
     auto captured_pt = piece_type_on(to_square);
@@ -163,12 +285,18 @@ inline void Position::make_move(Move move) {
         case Move::Type::CAPTURE:
             remove_piece(to_square, *captured_pt, !stm);
             move_piece(from_square, to_square, *moving_pt, stm);
+            next_state.captured_pt_ = captured_pt->value();
             break;
-        case Move::Type::DOUBLE_PUSH:
+        case Move::Type::DOUBLE_PUSH: {
             move_piece(from_square, to_square, constants::PAWN, stm);
-            next_state.enpassant_square_ =
+            Square ep_sq =
                 stm == constants::WHITE ? Square(from_square + 8) : Square(from_square - 8);
+            next_state.set_enpassant_square(ep_sq);
+            if (enpassant_capture_possible(ep_sq, !stm)) {
+                next_state.hash_ ^= zobrist::enpassant_key(ep_sq);
+            }
             break;
+        }
         case Move::Type::ENPASSANT:
             move_piece(from_square, to_square, constants::PAWN, stm);
             remove_piece(stm == constants::WHITE ? Square(to_square - 8) : Square(to_square + 8),
@@ -201,16 +329,79 @@ inline void Position::make_move(Move move) {
         case Move::Type::CAPTURE_PROMOTION:
             remove_piece(to_square, *captured_pt, !stm);
             remove_piece(from_square, constants::PAWN, stm);
+            next_state.captured_pt_ = captured_pt->value();
             put_piece(to_square, *promotion_pt, stm);
             break;
         case Move::Type::NONE:
             break;
     }
-    next_state.captured_pt_ = captured_pt;
     next_state.move_type_ = move_type;
     reverse_side_to_move();
-    next_state.hash_ = calculate_hash();
-    next_state.pawn_hash_ = calculate_pawn_hash();
+}
+
+inline void Position::push_accumulator() {
+    nnue::AccumulatorState& next = accumulators_.push_back();
+    next.reset(false);
+    const State& curr_state = state();
+    Move::Type move_type = curr_state.move_type_;
+    if (move_type == Move::Type::NONE) {
+        return;
+    }
+    constexpr std::uint8_t none = nnue::DirtyPiece::NO_SQUARE;
+    Color stm = !side_to_move();
+    Move move = curr_state.previous_move_;
+    Square from_square = move.from_square();
+    Square to_square = move.to_square();
+    std::uint8_t from = std::uint8_t(from_square.value());
+    std::uint8_t to = std::uint8_t(to_square.value());
+    if (curr_state.captured_pt_ != NO_PIECE_TYPE) {
+        next.add_dirty_piece(Piece{PieceType{curr_state.captured_pt_}, !stm}, to, none);
+    }
+    switch (move_type) {
+        case Move::Type::NORMAL:
+        case Move::Type::CAPTURE:
+        case Move::Type::DOUBLE_PUSH: {
+            // Kings are not features, but every feature of their side depends on them
+            PieceType moving_pt = *piece_type_on(to_square);
+            if (moving_pt == constants::KING) {
+                next.needs_refresh[stm.value()] = true;
+            } else {
+                next.add_dirty_piece(Piece{moving_pt, stm}, from, to);
+            }
+            break;
+        }
+        case Move::Type::ENPASSANT: {
+            Square captured_sq = lookups::pawn_shift(to_square, !stm);
+            next.add_dirty_piece(
+                Piece{constants::PAWN, !stm}, std::uint8_t(captured_sq.value()), none);
+            next.add_dirty_piece(Piece{constants::PAWN, stm}, from, to);
+            break;
+        }
+        case Move::Type::CASTLING: {
+            next.needs_refresh[stm.value()] = true;
+            bool king_side = to_square > from_square;
+            std::uint8_t rook_from = king_side ? to + 1 : to - 2;
+            std::uint8_t rook_to = king_side ? to - 1 : to + 1;
+            next.add_dirty_piece(Piece{constants::ROOK, stm}, rook_from, rook_to);
+            break;
+        }
+        case Move::Type::PROMOTION:
+        case Move::Type::CAPTURE_PROMOTION:
+            next.add_dirty_piece(Piece{constants::PAWN, stm}, from, none);
+            next.add_dirty_piece(Piece{*move.promotion_piece_type(), stm}, none, to);
+            break;
+        case Move::Type::NONE:
+            break;
+    }
+}
+
+// Below the ply set_network() was called at, the accumulator is rebuilt instead
+inline void Position::pop_accumulator() {
+    if (accumulators_.size() > 1) {
+        accumulators_.pop_back();
+    } else {
+        accumulators_.back().reset(true);
+    }
 }
 
 inline void Position::make_null_move() {
@@ -221,13 +412,21 @@ inline void Position::make_null_move() {
     history_.push_back(State{});
     State& prev = state_mut_ref(ply_ - 1);
     State& next = state_mut_ref();
+    next.hash_ = prev.hash_ ^ zobrist::side_to_move_key();
+    next.pawn_hash_ = prev.pawn_hash_;
+    auto prev_ep_sq = prev.enpassant_square();
+    if (prev_ep_sq && enpassant_capture_possible(*prev_ep_sq, side_to_move())) {
+        next.hash_ ^= zobrist::enpassant_key(*prev_ep_sq);
+    }
     reverse_side_to_move();
-    next.previous_move_ = {};
     next.halfmoves_ = prev.halfmoves_ + 1;
     next.castling_rights_ = prev.castling_rights_;
-    next.enpassant_square_ = {};
-    next.hash_ = calculate_hash();
-    next.pawn_hash_ = calculate_pawn_hash();
+    check_info_history_.push_back(calculate_check_info());
+    if (network_) {
+        push_accumulator();
+    }
+    assert(hash() == calculate_hash());
+    assert(pawn_hash() == calculate_pawn_hash());
 }
 
 }  // namespace libchess
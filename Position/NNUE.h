@@ -0,0 +1,110 @@
+#ifndef LIBCHESS_POSITION_NNUE_H
+#define LIBCHESS_POSITION_NNUE_H
+
+namespace libchess {
+
+// The network must outlive the position, or be replaced first; nullptr drops the accumulators.
+// Both kings must be on the board. The accumulator stack is allocated here with room for
+// ACCUMULATOR_PLIES, kept across calls, and grows when a line goes deeper.
+inline void Position::set_network(const nnue::Network* network) {
+    network_ = network;
+    if (!network_) {
+        accumulators_ = HistoryStack<nnue::AccumulatorState>{};
+        return;
+    }
+    if (accumulators_.capacity() == 0) {
+        accumulators_ = HistoryStack<nnue::AccumulatorState>{ACCUMULATOR_PLIES};
+    }
+    accumulators_.clear();
+    accumulators_.push_back().reset(true);
+}
+
+// The accumulator of the current position, brought up to date first. Requires a network.
+inline const nnue::Accumulator& Position::accumulator() const {
+    assert(network_);
+    update_accumulator(constants::WHITE);
+    update_accumulator(constants::BLACK);
+    return accumulators_.back().accumulator;
+}
+
+// Requires a network, see set_network()
+inline int Position::nnue_evaluate() const {
+    return network_->evaluate(accumulator(), side_to_move());
+}
+
+inline void Position::update_accumulator(Color perspective) const {
+    int p = perspective.value();
+    std::size_t top = accumulators_.size() - 1;
+    if (accumulators_[top].computed[p]) {
+        return;
+    }
+    // The ply set_network() was called at is computed or needs a refresh, which ends the walk
+    std::size_t first = top;
+    while (!accumulators_[first].needs_refresh[p] && !accumulators_[first - 1].computed[p]) {
+        --first;
+    }
+    // Past a move of this side's king every feature changed, so there is nothing to build on
+    if (accumulators_[first].needs_refresh[p]) {
+        refresh_accumulator(perspective);
+        return;
+    }
+
+    // The king has not moved since, so it stands where it does now
+    Square king_sq = king_square(perspective);
+    for (std::size_t i = first; i <= top; ++i) {
+        nnue::AccumulatorState& next = accumulators_[i];
+        std::memcpy(next.accumulator.values[p],
+                    accumulators_[i - 1].accumulator.values[p],
+                    sizeof(next.accumulator.values[p]));
+        for (int j = 0; j < next.dirty_count; ++j) {
+            const nnue::DirtyPiece& dirty_piece = next.dirty_pieces[j];
+            Piece piece{dirty_piece.piece};
+            if (dirty_piece.from_square != nnue::DirtyPiece::NO_SQUARE) {
+                network_->remove_feature(next.accumulator,
+                                         perspective,
+                                         nnue::feature_index(perspective,
+                                                             king_sq,
+                                                             Square{dirty_piece.from_square},
+                                                             piece.type(),
+                                                             piece.color()));
+            }
+            if (dirty_piece.to_square != nnue::DirtyPiece::NO_SQUARE) {
+                network_->add_feature(next.accumulator,
+                                      perspective,
+                                      nnue::feature_index(perspective,
+                                                          king_sq,
+                                                          Square{dirty_piece.to_square},
+                                                          piece.type(),
+                                                          piece.color()));
+            }
+        }
+        next.computed[p] = true;
+    }
+}
+
+inline void Position::refresh_accumulator(Color perspective) const {
+    nnue::AccumulatorState& top = accumulators_.back();
+    network_->reset(top.accumulator, perspective);
+    Square king_sq = king_square(perspective);
+    for (Color c : constants::COLORS) {
+        for (PieceType pt : {constants::PAWN,
+                             constants::KNIGHT,
+                             constants::BISHOP,
+                             constants::ROOK,
+                             constants::QUEEN}) {
+            Bitboard bb = piece_type_bb(pt, c);
+            while (bb) {
+                network_->add_feature(
+                    top.accumulator,
+                    perspective,
+                    nnue::feature_index(perspective, king_sq, bb.forward_bitscan(), pt, c));
+                bb.forward_popbit();
+            }
+        }
+    }
+    top.computed[perspective.value()] = true;
+}
+
+}  // namespace libchess
+
+#endif  // LIBCHESS_POSITION_NNUE_H
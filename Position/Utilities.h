@@ -92,7 +92,7 @@ inline std::string Position::uci_line() const {
     std::string result = "position " + start_fen();
     result += " moves";
     for (int p = 1; p <= ply(); ++p) {
-        auto prev_move = state(p).previous_move_;
+        auto prev_move = state(p).previous_move();
         result += " " + (prev_move ? prev_move->to_str() : "0000");
     }
     return result;
@@ -112,89 +112,85 @@ inline void Position::vflip() {
     color_bb_[0] = color_bb_[1];
     color_bb_[1] = tmp;
 
+    std::array<std::uint8_t, 64> flipped_mailbox;
+    for (Square sq : constants::SQUARES) {
+        std::uint8_t piece_value = mailbox_[sq.flipped()];
+        if (piece_value != NO_PIECE) {
+            Piece piece{piece_value};
+            piece_value = Piece{piece.type(), !piece.color()}.value();
+        }
+        flipped_mailbox[sq] = piece_value;
+    }
+    mailbox_ = flipped_mailbox;
+
     State& curr_state = state_mut_ref();
-    if (curr_state.enpassant_square_) {
-        *curr_state.enpassant_square_ = curr_state.enpassant_square_->flipped();
+    auto ep_sq = curr_state.enpassant_square();
+    if (ep_sq) {
+        curr_state.set_enpassant_square(ep_sq->flipped());
     }
 
-    CastlingRights tmp_cr = CastlingRights{(curr_state.castling_rights_.value() & 3) << 2};
-    curr_state.castling_rights_.value_mut_ref() >>= 2;
-    curr_state.castling_rights_.value_mut_ref() ^= tmp_cr.value();
+    std::uint8_t castling_rights = curr_state.castling_rights_;
+    curr_state.castling_rights_ = ((castling_rights & 3) << 2) | (castling_rights >> 2);
 
     side_to_move_ = !side_to_move_;
 
     state_mut_ref().hash_ = calculate_hash();
     state_mut_ref().pawn_hash_ = calculate_pawn_hash();
+    check_info_history_.back() = calculate_check_info();
+    refresh_material();
+    if (network_) {
+        accumulators_.back().reset(true);
+    }
 }
 
-inline std::optional<Move> Position::smallest_capture_move_to(Square square) const {
-    Bitboard pawn_attackers_bb = lookups::pawn_attacks(square, !side_to_move()) &
-                                 piece_type_bb(constants::PAWN, side_to_move());
-    if (pawn_attackers_bb) {
-        Square from_square = pawn_attackers_bb.forward_bitscan();
-        auto enpassant_sq = enpassant_square();
-        if (enpassant_sq && *enpassant_sq == square) {
-            return Move{from_square, square, Move::Type::ENPASSANT};
-        }
-        if (lookups::relative_rank(square.rank(), side_to_move()) == constants::RANK_8) {
-            return Move{from_square, square, constants::QUEEN, Move::Type::CAPTURE_PROMOTION};
-        }
-        return Move{from_square, square, Move::Type::CAPTURE};
-    }
+// The table must outlive the position, or be replaced first; nullptr stops the PSQT sums
+inline void Position::set_psqt(const PSQT* psqt) {
+    psqt_ = psqt;
+    refresh_material();
+}
 
-    auto piece_types_iter = constants::PIECE_TYPES + 1;
-    auto piece_types_end = constants::PIECE_TYPES + 6;
-    for (; piece_types_iter != piece_types_end; ++piece_types_iter) {
-        Bitboard attackers_bb =
-            lookups::non_pawn_piece_type_attacks(*piece_types_iter, square, occupancy_bb()) &
-            piece_type_bb(*piece_types_iter, side_to_move());
-        if (attackers_bb) {
-            return Move{attackers_bb.forward_bitscan(), square, Move::Type::CAPTURE};
+inline void Position::refresh_material() {
+    material_key_ = calculate_material_key();
+    for (Color c : constants::COLORS) {
+        psqt_mg_[c.value()] = 0;
+        psqt_eg_[c.value()] = 0;
+        for (PieceType pt : constants::PIECE_TYPES) {
+            Bitboard bb = piece_type_bb(pt, c);
+            piece_counts_[c.value()][pt.value()] = std::uint8_t(bb.popcount());
+            while (psqt_ && bb) {
+                Square sq = bb.forward_bitscan();
+                psqt_mg_[c.value()] += psqt_->mg_value(sq, pt, c);
+                psqt_eg_[c.value()] += psqt_->eg_value(sq, pt, c);
+                bb.forward_popbit();
+            }
         }
     }
-
-    return std::nullopt;
 }
 
-inline int Position::see_to(Square square, std::array<int, 6> piece_values) {
-    auto smallest_capture_move = smallest_capture_move_to(square);
-    if (!smallest_capture_move) {
-        return 0;
-    }
-    bool is_enpassant = smallest_capture_move->type() == Move::Type::ENPASSANT;
-
-    auto square_pt = piece_on(square);
-    if (!square_pt && !is_enpassant) {
-        return 0;
+// Grows the history to hold `plies` more moves than it holds now, e.g. MAX_PLY past the current
+// position of a long game. Allocates, so call it outside of a search.
+inline void Position::reserve_history(int plies) {
+    history_.reserve(history_.size() + plies);
+    check_info_history_.reserve(check_info_history_.size() + plies);
+    if (network_) {
+        accumulators_.reserve(accumulators_.size() + plies);
     }
+}
 
-    int piece_val = is_enpassant ? piece_values.at(0) : piece_values.at(square_pt->type().value());
-    auto smallest_capture_move_prom_piece_type = smallest_capture_move->promotion_piece_type();
-    if (smallest_capture_move_prom_piece_type) {
-        piece_val +=
-            piece_values.at(smallest_capture_move_prom_piece_type->value()) - piece_values.at(0);
-    }
-    Position pos = *this;
-    pos.make_move(*smallest_capture_move);
-    return std::max(0, piece_val - pos.see_to(square, piece_values));
+inline std::optional<Move> Position::smallest_capture_move_to(Square square) const {
+    return movegen::smallest_capture_move_to(*this, square);
 }
 
-inline int Position::see_for(Move move, std::array<int, 6> piece_values) {
-    bool is_enpassant = move_type_of(move) == Move::Type::ENPASSANT;
+inline int Position::see_to(Square square, std::array<int, 6> piece_values) const {
+    return movegen::see_to(*this, square, piece_values);
+}
 
-    auto square_pt = piece_on(move.to_square());
-    if (!square_pt && !is_enpassant) {
-        return 0;
-    }
+inline int Position::see_for(Move move, std::array<int, 6> piece_values) const {
+    return movegen::see_for(*this, move, piece_values);
+}
 
-    int piece_val = is_enpassant ? piece_values.at(0) : piece_values.at(square_pt->type().value());
-    auto move_prom_piece_type = move.promotion_piece_type();
-    if (move_prom_piece_type) {
-        piece_val += piece_values.at(move_prom_piece_type->value()) - piece_values.at(0);
-    }
-    Position pos = *this;
-    pos.make_move(move);
-    return std::max(0, piece_val - pos.see_to(move.to_square(), piece_values));
+inline bool Position::see_ge(Move move, int threshold, std::array<int, 6> piece_values) const {
+    return movegen::see_ge(*this, move, threshold, piece_values);
 }
 
 inline std::optional<Position> Position::from_fen(const std::string& fen) {
@@ -228,11 +224,11 @@ inline std::optional<Position> Position::from_fen(const std::string& fen) {
 
     // Castling rights
     fen_stream >> fen_part;
-    curr_state.castling_rights_ = CastlingRights::from(fen_part);
+    curr_state.set_castling_rights(CastlingRights::from(fen_part));
 
     // Enpassant square
     fen_stream >> fen_part;
-    curr_state.enpassant_square_ = Square::from(fen_part);
+    curr_state.set_enpassant_square(Square::from(fen_part));
 
     // Halfmoves
     fen_stream >> fen_part;
@@ -247,6 +243,7 @@ inline std::optional<Position> Position::from_fen(const std::string& fen) {
 
     pos.state_mut_ref().hash_ = pos.calculate_hash();
     pos.state_mut_ref().pawn_hash_ = pos.calculate_pawn_hash();
+    pos.check_info_history_.push_back(pos.calculate_check_info());
     pos.start_fen_ = fen;
     return pos;
 }
@@ -294,13 +291,19 @@ inline std::optional<Position> Position::from_uci_position_line(const std::strin
     if (!pos) {
         return {};
     }
+    std::vector<Move> moves;
     std::string move_str;
     while (line_stream >> move_str) {
         auto move = Move::from(move_str);
         if (!move) {
             return {};
         }
-        pos->make_move(*move);
+        moves.push_back(*move);
+    }
+    // Leave MAX_PLY moves of room past the game for the search
+    pos->reserve_history(int(moves.size()) + MAX_PLY);
+    for (Move move : moves) {
+        pos->make_move(move);
     }
 
     return pos;
@@ -0,0 +1,250 @@
+#ifndef LIBCHESS_TRANSPOSITIONTABLE_H
+#define LIBCHESS_TRANSPOSITIONTABLE_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+
+#include "Move.h"
+#include "internal/Intrinsics.h"
+#include "internal/LargeMemory.h"
+
+namespace libchess {
+
+/// A transposition table shared by any number of search threads without locks. Entries are
+/// single 64-bit words holding a 16-bit key check, the move, score, depth, bound and the
+/// generation they were written in, so a probe never sees a torn entry; two threads storing the
+/// same slot at once only lose one of the stores. Eight entries form a 64-byte cluster, one cache
+/// line, picked by the high bits of the hash. Stores replace the entry of the same position in
+/// the cluster unless it is much deeper, or else the one with the least depth after aging out
+/// older searches.
+///
+/// The clusters live in a LargeBuffer, on huge pages where the system allows, and are constructed
+/// and zeroed from several threads so that on NUMA systems the pages interleave across the nodes.
+///
+/// Scores are stored as given: mate scores must be made relative to the node before storing and
+/// back to the root after probing by the caller.
+class TranspositionTable {
+   public:
+    using hash_type = std::uint64_t;
+
+    enum class Bound : std::uint8_t
+    {
+        NONE,
+        UPPER,
+        LOWER,
+        EXACT
+    };
+
+    struct Entry {
+        std::optional<Move> move;
+        int score;
+        int depth;
+        Bound bound;
+    };
+
+    constexpr static int MIN_DEPTH = -128;
+    constexpr static int MAX_DEPTH = 127;
+
+    explicit TranspositionTable(std::size_t megabytes, int threads = 1) {
+        resize(megabytes, threads);
+    }
+    TranspositionTable(const TranspositionTable&) = delete;
+    TranspositionTable& operator=(const TranspositionTable&) = delete;
+
+    // Reallocates an empty table of at most the given size, and at least one cluster, built by
+    // the given number of threads. Must not be called while other threads use the table.
+    void resize(std::size_t megabytes, int threads = 1) {
+        cluster_count_ = std::max<std::size_t>((megabytes << 20) / sizeof(Cluster), 1);
+        buffer_ = memory::LargeBuffer{cluster_count_ * sizeof(Cluster)};
+        clusters_ = static_cast<Cluster*>(buffer_.data());
+        // Constructing the clusters is their first write, which places each page
+        memory::for_each_chunk_interleaved(
+            size_bytes(), threads, [this](std::size_t begin, std::size_t end) {
+                std::uninitialized_default_construct_n(clusters_ + begin / sizeof(Cluster),
+                                                       (end - begin) / sizeof(Cluster));
+            });
+        generation_ = 0;
+    }
+
+    // Empties the table for ucinewgame, with the huge pages spread over the threads
+    void clear(int threads = 1) {
+        memory::for_each_chunk_interleaved(
+            size_bytes(), threads, [this](std::size_t begin, std::size_t end) {
+                clear_clusters(begin / sizeof(Cluster), end / sizeof(Cluster));
+            });
+        generation_ = 0;
+    }
+
+    // Call before each search, while no thread uses the table, so that entries of earlier
+    // searches are replaced first
+    void new_search() {
+        generation_ = (generation_ + 1) & GENERATION_MASK;
+    }
+
+    // Starts loading the cluster of hash into cache, e.g. with Position::hash_after() before the
+    // move is made
+    void prefetch(hash_type hash) const {
+        intrinsics::prefetch(&cluster_of(hash));
+    }
+
+    std::optional<Entry> probe(hash_type hash) const {
+        std::uint16_t key = key_of(hash);
+        for (const auto& slot : cluster_of(hash).entries) {
+            std::uint64_t data = slot.load(std::memory_order_relaxed);
+            if (key_field(data) == key && bound_field(data) != Bound::NONE) {
+                return decode(data);
+            }
+        }
+        return std::nullopt;
+    }
+
+    // A null move keeps the move already stored for the position. An entry of the same position
+    // keeps its score, depth and bound against a much shallower non-exact store of the same
+    // search, but always takes the new move.
+    void store(hash_type hash, Move move, int score, int depth, Bound bound) {
+        std::uint16_t key = key_of(hash);
+        depth = std::clamp(depth, MIN_DEPTH, MAX_DEPTH);
+        Cluster& cluster = cluster_of(hash);
+        std::atomic<std::uint64_t>* replace = &cluster.entries[0];
+        int replace_value = MAX_DEPTH + 1;
+        for (auto& slot : cluster.entries) {
+            std::uint64_t data = slot.load(std::memory_order_relaxed);
+            if (bound_field(data) == Bound::NONE) {
+                replace = &slot;
+                break;
+            }
+            if (key_field(data) == key) {
+                if (move == Move{}) {
+                    move = Move{std::uint32_t(move_field(data))};
+                }
+                if (bound != Bound::EXACT && depth < depth_field(data) - SAME_KEY_DEPTH_MARGIN &&
+                    generation_field(data) == generation_) {
+                    slot.store(with_move(data, move), std::memory_order_relaxed);
+                    return;
+                }
+                replace = &slot;
+                break;
+            }
+            int age = (generation_ - generation_field(data)) & GENERATION_MASK;
+            int value = depth_field(data) - 8 * age;
+            if (value < replace_value) {
+                replace_value = value;
+                replace = &slot;
+            }
+        }
+        replace->store(encode(key, move, score, depth, bound), std::memory_order_relaxed);
+    }
+
+    // Permille of sampled entries written in the current search, for UCIInfoParameters::hashfull
+    int hashfull() const {
+        std::size_t sample = std::min<std::size_t>(cluster_count_, 1000 / CLUSTER_SIZE);
+        int used = 0;
+        for (std::size_t i = 0; i < sample; ++i) {
+            for (const auto& slot : clusters_[i].entries) {
+                std::uint64_t data = slot.load(std::memory_order_relaxed);
+                used += bound_field(data) != Bound::NONE && generation_field(data) == generation_;
+            }
+        }
+        return int(used * 1000 / (sample * CLUSTER_SIZE));
+    }
+
+    std::size_t size_bytes() const {
+        return cluster_count_ * sizeof(Cluster);
+    }
+    memory::PageKind page_kind() const {
+        return buffer_.page_kind();
+    }
+
+   private:
+    constexpr static int CLUSTER_SIZE = 8;
+    constexpr static int GENERATION_MASK = 0x3f;
+    // How much shallower than the stored entry a store of the same position may be and still
+    // replace it
+    constexpr static int SAME_KEY_DEPTH_MARGIN = 3;
+
+    // Bit layout of an entry, from the least significant bit: 16 key, 16 move without its type,
+    // 16 score, 8 depth, 2 bound and 6 generation. An all-zero entry has no bound and is empty.
+    enum Shift : int
+    {
+        MOVE_SHIFT = 16,
+        SCORE_SHIFT = 32,
+        DEPTH_SHIFT = 48,
+        BOUND_SHIFT = 56,
+        GENERATION_SHIFT = 58
+    };
+
+    struct alignas(64) Cluster {
+        std::atomic<std::uint64_t> entries[CLUSTER_SIZE] = {};
+    };
+    static_assert(sizeof(Cluster) == 64);
+
+    static std::uint16_t key_of(hash_type hash) {
+        return std::uint16_t(hash);
+    }
+    static std::uint16_t key_field(std::uint64_t data) {
+        return std::uint16_t(data);
+    }
+    static std::uint16_t move_field(std::uint64_t data) {
+        return std::uint16_t(data >> MOVE_SHIFT);
+    }
+    static int depth_field(std::uint64_t data) {
+        return std::int8_t(data >> DEPTH_SHIFT);
+    }
+    static Bound bound_field(std::uint64_t data) {
+        return Bound((data >> BOUND_SHIFT) & 3);
+    }
+    static int generation_field(std::uint64_t data) {
+        return int(data >> GENERATION_SHIFT);
+    }
+
+    std::uint64_t encode(std::uint16_t key, Move move, int score, int depth, Bound bound) const {
+        score = std::clamp(score, INT16_MIN, INT16_MAX);
+        depth = std::clamp(depth, MIN_DEPTH, MAX_DEPTH);
+        return std::uint64_t(key) | (std::uint64_t(move.value_sans_type() & 0xffff) << MOVE_SHIFT) |
+               (std::uint64_t(std::uint16_t(score)) << SCORE_SHIFT) |
+               (std::uint64_t(std::uint8_t(depth)) << DEPTH_SHIFT) |
+               (std::uint64_t(bound) << BOUND_SHIFT) |
+               (std::uint64_t(generation_) << GENERATION_SHIFT);
+    }
+    static std::uint64_t with_move(std::uint64_t data, Move move) {
+        return (data & ~(std::uint64_t(0xffff) << MOVE_SHIFT)) |
+               (std::uint64_t(move.value_sans_type() & 0xffff) << MOVE_SHIFT);
+    }
+    static Entry decode(std::uint64_t data) {
+        Move move{std::uint32_t(move_field(data))};
+        return Entry{move == Move{} ? std::nullopt : std::optional<Move>{move},
+                     std::int16_t(data >> SCORE_SHIFT),
+                     depth_field(data),
+                     bound_field(data)};
+    }
+
+    // The high bits of hash * cluster_count_ index the clusters, which spreads hashes over a
+    // table of any size and leaves the low bits for the key
+    const Cluster& cluster_of(hash_type hash) const {
+        return clusters_[std::size_t(intrinsics::mul_hi64(hash, cluster_count_))];
+    }
+    Cluster& cluster_of(hash_type hash) {
+        return clusters_[std::size_t(intrinsics::mul_hi64(hash, cluster_count_))];
+    }
+
+    void clear_clusters(std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) {
+            for (auto& slot : clusters_[i].entries) {
+                slot.store(0, std::memory_order_relaxed);
+            }
+        }
+    }
+
+    memory::LargeBuffer buffer_;
+    Cluster* clusters_;
+    std::size_t cluster_count_;
+    int generation_;
+};
+
+}  // namespace libchess
+
+#endif  // LIBCHESS_TRANSPOSITIONTABLE_H
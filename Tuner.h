@@ -59,6 +59,8 @@ enum class Result
     WHITE_WIN
 };
 
+// Position may also be a Board, e.g. parsed with Position{fen}.board(), so that a large data set
+// holds no per-position heap allocations and copies of it are plain memcpys
 template <class Position>
 class NormalizedResult {
    public:
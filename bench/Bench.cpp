@@ -0,0 +1,231 @@
+#include <chrono>
+#include <iomanip>
+#include <string>
+#include <vector>
+
+#include "../Position.h"
+
+using namespace libchess;
+using namespace constants;
+
+namespace {
+
+const std::vector<std::string> BENCH_FENS = {
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+    "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+    "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+    "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+};
+
+template <class F>
+void run(const std::string& name, long long operations, F&& f) {
+    auto start_ts = std::chrono::steady_clock::now();
+    f();
+    auto end_ts = std::chrono::steady_clock::now();
+    std::chrono::duration<double> diff_ts = end_ts - start_ts;
+    double time_s = diff_ts.count();
+    std::cout << std::left << std::setw(18) << name << std::right << std::fixed
+              << std::setprecision(2) << std::setw(10) << time_s * 1e9 / operations << " ns/op"
+              << std::setw(10) << operations / time_s / 1e6 << " Mops/s\n";
+}
+
+// Makes and unmakes every legal move of each bench position
+void bench_make_unmake(int iterations) {
+    std::vector<std::pair<Position, MoveList>> positions;
+    long long operations = 0;
+    for (const auto& fen : BENCH_FENS) {
+        Position pos{fen};
+        MoveList move_list = pos.legal_move_list();
+        operations += move_list.size();
+        positions.emplace_back(pos, move_list);
+    }
+    operations *= iterations;
+
+    std::uint64_t checksum = 0;
+    run("make/unmake", operations, [&] {
+        for (int i = 0; i < iterations; ++i) {
+            for (auto& [pos, move_list] : positions) {
+                for (Move move : move_list) {
+                    pos.make_move(move);
+                    checksum += pos.hash();
+                    pos.unmake_move();
+                }
+            }
+        }
+    });
+    if (checksum == 0) {
+        std::cout << "unexpected checksum\n";
+    }
+}
+
+// Makes and unmakes every legal move of each bench position with a caller-owned UndoInfo
+void bench_make_unmake_undo(int iterations) {
+    std::vector<std::pair<Position, MoveList>> positions;
+    long long operations = 0;
+    for (const auto& fen : BENCH_FENS) {
+        Position pos{fen};
+        MoveList move_list = pos.legal_move_list();
+        operations += move_list.size();
+        positions.emplace_back(pos, move_list);
+    }
+    operations *= iterations;
+
+    std::uint64_t checksum = 0;
+    Position::UndoInfo undo;
+    run("make/unmake undo", operations, [&] {
+        for (int i = 0; i < iterations; ++i) {
+            for (auto& [pos, move_list] : positions) {
+                for (Move move : move_list) {
+                    pos.make_move(move, undo);
+                    checksum += pos.hash();
+                    pos.unmake_move(move, undo);
+                }
+            }
+        }
+    });
+    if (checksum == 0) {
+        std::cout << "unexpected checksum\n";
+    }
+}
+
+// Copy-makes every legal move of each bench position on its Board
+void bench_copy_make(int iterations) {
+    std::vector<std::pair<Board, MoveList>> boards;
+    long long operations = 0;
+    for (const auto& fen : BENCH_FENS) {
+        Position pos{fen};
+        MoveList move_list = pos.legal_move_list();
+        operations += move_list.size();
+        boards.emplace_back(pos.board(), move_list);
+    }
+    operations *= iterations;
+
+    std::uint64_t checksum = 0;
+    run("copy-make", operations, [&] {
+        for (int i = 0; i < iterations; ++i) {
+            for (const auto& [board, move_list] : boards) {
+                for (Move move : move_list) {
+                    Board child = board;
+                    child.make_move(move);
+                    checksum += child.hash();
+                }
+            }
+        }
+    });
+    if (checksum == 0) {
+        std::cout << "unexpected checksum\n";
+    }
+}
+
+// Generates the legal moves of each bench position
+void bench_legal_move_list(int iterations) {
+    std::vector<Position> positions;
+    for (const auto& fen : BENCH_FENS) {
+        positions.emplace_back(fen);
+    }
+    long long operations = static_cast<long long>(positions.size()) * iterations;
+
+    long long moves = 0;
+    run("legal_move_list", operations, [&] {
+        for (int i = 0; i < iterations; ++i) {
+            for (const auto& pos : positions) {
+                moves += pos.legal_move_list().size();
+            }
+        }
+    });
+    if (moves == 0) {
+        std::cout << "unexpected move count\n";
+    }
+}
+
+// Classifies each bench position as a PGN scan does for every position it reads
+void bench_game_state(int iterations) {
+    std::vector<Position> positions;
+    for (const auto& fen : BENCH_FENS) {
+        positions.emplace_back(fen);
+    }
+    long long operations = static_cast<long long>(positions.size()) * iterations;
+
+    int in_progress = 0;
+    run("game_state", operations, [&] {
+        for (int i = 0; i < iterations; ++i) {
+            for (const auto& pos : positions) {
+                in_progress += pos.game_state() == Position::GameState::IN_PROGRESS;
+            }
+        }
+    });
+    if (in_progress == 0) {
+        std::cout << "unexpected game states\n";
+    }
+}
+
+// Validates the legal moves of every bench position, most of them illegal elsewhere, in each bench
+// position, as a search does with TT moves and killers
+void bench_is_legal_move(int iterations) {
+    std::vector<Position> positions;
+    std::vector<Move> candidates;
+    for (const auto& fen : BENCH_FENS) {
+        positions.emplace_back(fen);
+        for (Move move : positions.back().legal_move_list()) {
+            candidates.push_back(move);
+        }
+    }
+    long long operations =
+        static_cast<long long>(positions.size()) * candidates.size() * iterations;
+
+    int legal = 0;
+    run("is_legal_move", operations, [&] {
+        for (int i = 0; i < iterations; ++i) {
+            for (const auto& pos : positions) {
+                for (Move move : candidates) {
+                    legal += pos.is_legal_move(move);
+                }
+            }
+        }
+    });
+    if (legal == 0) {
+        std::cout << "unexpected legal move count\n";
+    }
+}
+
+// Looks up the piece on every square of each bench position
+void bench_piece_on(int iterations) {
+    std::vector<Position> positions;
+    for (const auto& fen : BENCH_FENS) {
+        positions.emplace_back(fen);
+    }
+    long long operations = 64LL * positions.size() * iterations;
+
+    int occupied = 0;
+    run("piece_on", operations, [&] {
+        for (int i = 0; i < iterations; ++i) {
+            for (const auto& pos : positions) {
+                for (Square sq : SQUARES) {
+                    occupied += pos.piece_on(sq).has_value();
+                }
+            }
+        }
+    });
+    if (occupied == 0) {
+        std::cout << "unexpected occupancy\n";
+    }
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    int iterations = argc > 1 ? std::atoi(argv[1]) : 20000;
+    std::cout << "slider backend: " << lookups::slider_backend_name() << "\n";
+    std::cout << "sizeof(Position): " << sizeof(Position) << "\n";
+    std::cout << "sizeof(Board): " << sizeof(Board) << "\n";
+    bench_make_unmake(iterations);
+    bench_make_unmake_undo(iterations);
+    bench_copy_make(iterations);
+    bench_legal_move_list(iterations);
+    bench_is_legal_move(iterations / 10);
+    bench_game_state(iterations);
+    bench_piece_on(iterations);
+    return 0;
+}
@@ -0,0 +1,66 @@
+#ifndef LIBCHESS_CPUFEATURES_H
+#define LIBCHESS_CPUFEATURES_H
+
+#include <cstdint>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#define LIBCHESS_HAS_PEXT 1
+#define LIBCHESS_HAS_X86_SIMD 1
+#include <immintrin.h>
+#endif
+
+namespace libchess::cpu {
+
+inline bool supports_pext() {
+#ifdef LIBCHESS_HAS_PEXT
+    // May run from static initializers, before the runtime has filled in the CPU model
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("bmi2");
+#else
+    return false;
+#endif
+}
+
+inline bool has_fast_pext() {
+#ifdef LIBCHESS_HAS_PEXT
+    if (!supports_pext()) {
+        return false;
+    }
+    // AMD implemented pext/pdep in microcode before Zen 3, which is slower than a magic multiply
+    return !(__builtin_cpu_is("amd") &&
+             (__builtin_cpu_is("bdver4") || __builtin_cpu_is("znver1") ||
+              __builtin_cpu_is("znver2")));
+#else
+    return false;
+#endif
+}
+
+inline bool supports_sse41() {
+#ifdef LIBCHESS_HAS_X86_SIMD
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("sse4.1");
+#else
+    return false;
+#endif
+}
+
+inline bool supports_avx2() {
+#ifdef LIBCHESS_HAS_X86_SIMD
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#else
+    return false;
+#endif
+}
+
+#ifdef LIBCHESS_HAS_PEXT
+// Compiled for BMI2 on its own so that the rest of the library keeps the baseline instruction set.
+// Only call this after supports_pext() has returned true.
+__attribute__((target("bmi2"))) inline std::uint64_t pext(std::uint64_t value, std::uint64_t mask) {
+    return _pext_u64(value, mask);
+}
+#endif
+
+}  // namespace libchess::cpu
+
+#endif  // LIBCHESS_CPUFEATURES_H
@@ -0,0 +1,109 @@
+#ifndef LIBCHESS_CUCKOO_H
+#define LIBCHESS_CUCKOO_H
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <utility>
+
+#include "../Lookups.h"
+#include "../Move.h"
+#include "Zobrist.h"
+
+namespace libchess::cuckoo {
+
+/// Every reversible move of a knight, bishop, rook, queen or king on an empty board, keyed by the
+/// change it makes to the position hash, side to move included. The difference between the keys
+/// of two positions then tells with one or two probes whether a single such move connects them.
+/// Both directions of a move share an entry, stored as the move from the lower square.
+class CuckooTable {
+   public:
+    constexpr static int SIZE = 8192;
+    // The number of distinct piece moves between two squares on an empty board, for both colors
+    constexpr static int MOVE_COUNT = 3668;
+
+    CuckooTable() {
+        keys_.fill(0);
+        moves_.fill(Move{});
+        for (Color c : constants::COLORS) {
+            for (PieceType pt = constants::KNIGHT; pt <= constants::KING; ++pt) {
+                for (Square from = constants::A1; from <= constants::H8; ++from) {
+                    for (Square to = from + 1; to <= constants::H8; ++to) {
+                        if (empty_board_attacks(pt, from) & Bitboard{to}) {
+                            insert(zobrist::piece_square_key(from, pt, c) ^
+                                       zobrist::piece_square_key(to, pt, c) ^
+                                       zobrist::side_to_move_key(),
+                                   Move{from, to});
+                        }
+                    }
+                }
+            }
+        }
+    }
+    CuckooTable(const CuckooTable&) = delete;
+    CuckooTable& operator=(const CuckooTable&) = delete;
+
+    std::optional<Move> probe(std::uint64_t key_diff) const {
+        int index = h1(key_diff);
+        if (keys_[index] != key_diff) {
+            index = h2(key_diff);
+            if (keys_[index] != key_diff) {
+                return std::nullopt;
+            }
+        }
+        return moves_[index];
+    }
+    int size() const {
+        return size_;
+    }
+
+   private:
+    static int h1(std::uint64_t key) {
+        return int(key & (SIZE - 1));
+    }
+    static int h2(std::uint64_t key) {
+        return int((key >> 16) & (SIZE - 1));
+    }
+    static Bitboard empty_board_attacks(PieceType pt, Square square) {
+        switch (pt) {
+            case constants::KNIGHT:
+                return lookups::knight_attacks(square);
+            case constants::BISHOP:
+                return lookups::bishop_attacks(square);
+            case constants::ROOK:
+                return lookups::rook_attacks(square);
+            case constants::QUEEN:
+                return lookups::queen_attacks(square);
+            default:
+                return lookups::king_attacks(square);
+        }
+    }
+
+    // Displaces the occupant of the first slot to its other slot until an empty one is found
+    void insert(std::uint64_t key, Move move) {
+        int index = h1(key);
+        while (true) {
+            std::swap(keys_[index], key);
+            std::swap(moves_[index], move);
+            if (move == Move{}) {
+                break;
+            }
+            index = index == h1(key) ? h2(key) : h1(key);
+        }
+        ++size_;
+    }
+
+    std::array<std::uint64_t, SIZE> keys_;
+    std::array<Move, SIZE> moves_;
+    int size_ = 0;
+};
+
+inline const CuckooTable CUCKOO_TABLE;
+
+inline std::optional<Move> probe(std::uint64_t key_diff) {
+    return CUCKOO_TABLE.probe(key_diff);
+}
+
+}  // namespace libchess::cuckoo
+
+#endif  // LIBCHESS_CUCKOO_H
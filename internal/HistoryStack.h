@@ -0,0 +1,118 @@
+#ifndef LIBCHESS_HISTORYSTACK_H
+#define LIBCHESS_HISTORYSTACK_H
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+
+namespace libchess {
+
+/// A stack over a buffer allocated up front, so that pushing and popping within the capacity never
+/// touch the heap. Pushing onto a full stack doubles the buffer, which moves the elements and
+/// invalidates references to them; reserve() grows it ahead of time instead. Copies keep the
+/// source's capacity so that a position copied for a search thread stays preallocated, and
+/// copy-assignment reuses the destination's buffer when it is large enough.
+template <class T>
+class HistoryStack {
+   public:
+    HistoryStack() : size_(0), capacity_(0) {
+    }
+    explicit HistoryStack(std::size_t capacity)
+        : data_(new T[capacity]), size_(0), capacity_(capacity) {
+    }
+    HistoryStack(const HistoryStack& other)
+        : data_(new T[other.capacity_]),
+          size_(other.size_),
+          capacity_(other.capacity_) {
+        std::copy(other.data_.get(), other.data_.get() + size_, data_.get());
+    }
+    HistoryStack& operator=(const HistoryStack& other) {
+        if (this == &other) {
+            return *this;
+        }
+        if (capacity_ < other.size_) {
+            data_.reset(new T[other.capacity_]);
+            capacity_ = other.capacity_;
+        }
+        std::copy(other.data_.get(), other.data_.get() + other.size_, data_.get());
+        size_ = other.size_;
+        return *this;
+    }
+    HistoryStack(HistoryStack&& other) noexcept
+        : data_(std::move(other.data_)), size_(other.size_), capacity_(other.capacity_) {
+        other.size_ = 0;
+        other.capacity_ = 0;
+    }
+    HistoryStack& operator=(HistoryStack&& other) noexcept {
+        data_ = std::move(other.data_);
+        size_ = other.size_;
+        capacity_ = other.capacity_;
+        other.size_ = 0;
+        other.capacity_ = 0;
+        return *this;
+    }
+
+    void push_back(const T& value) {
+        if (size_ == capacity_) {
+            grow();
+        }
+        data_[size_++] = value;
+    }
+    // Grows the stack by one element, left as it was, for the caller to fill in place
+    T& push_back() {
+        if (size_ == capacity_) {
+            grow();
+        }
+        return data_[size_++];
+    }
+    void pop_back() {
+        --size_;
+    }
+    void clear() {
+        size_ = 0;
+    }
+    void reserve(std::size_t capacity) {
+        if (capacity <= capacity_) {
+            return;
+        }
+        std::unique_ptr<T[]> data{new T[capacity]};
+        std::copy(data_.get(), data_.get() + size_, data.get());
+        data_ = std::move(data);
+        capacity_ = capacity;
+    }
+
+    T& operator[](std::size_t index) {
+        return data_[index];
+    }
+    const T& operator[](std::size_t index) const {
+        return data_[index];
+    }
+    T& back() {
+        return data_[size_ - 1];
+    }
+    const T& back() const {
+        return data_[size_ - 1];
+    }
+    std::size_t size() const {
+        return size_;
+    }
+    std::size_t capacity() const {
+        return capacity_;
+    }
+    bool empty() const {
+        return size_ == 0;
+    }
+
+   private:
+    void grow() {
+        reserve(std::max<std::size_t>(2 * capacity_, 16));
+    }
+
+    std::unique_ptr<T[]> data_;
+    std::size_t size_;
+    std::size_t capacity_;
+};
+
+}  // namespace libchess
+
+#endif  // LIBCHESS_HISTORYSTACK_H
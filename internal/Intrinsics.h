@@ -0,0 +1,60 @@
+#ifndef LIBCHESS_INTRINSICS_H
+#define LIBCHESS_INTRINSICS_H
+
+#include <cstdint>
+
+#if defined(__SIZEOF_INT128__)
+#define LIBCHESS_HAS_INT128 1
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
+#define LIBCHESS_HAS_UMULH 1
+#include <intrin.h>
+#endif
+
+#if !defined(__GNUC__) && defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#define LIBCHESS_HAS_MM_PREFETCH 1
+#include <xmmintrin.h>
+#endif
+
+/// Compiler-specific operations with a portable fallback
+namespace libchess::intrinsics {
+
+// The high 64 bits of the 128-bit product a * b, from four 32x32-bit products
+constexpr std::uint64_t mul_hi64_portable(std::uint64_t a, std::uint64_t b) {
+    std::uint64_t a_lo = a & 0xFFFFFFFF;
+    std::uint64_t a_hi = a >> 32;
+    std::uint64_t b_lo = b & 0xFFFFFFFF;
+    std::uint64_t b_hi = b >> 32;
+    std::uint64_t lo_lo = a_lo * b_lo;
+    std::uint64_t hi_lo = a_hi * b_lo;
+    std::uint64_t lo_hi = a_lo * b_hi;
+    std::uint64_t hi_hi = a_hi * b_hi;
+    // The middle column collects the carries out of the low 64 bits
+    std::uint64_t middle = (lo_lo >> 32) + (hi_lo & 0xFFFFFFFF) + lo_hi;
+    return hi_hi + (hi_lo >> 32) + (middle >> 32);
+}
+
+// The high 64 bits of the 128-bit product a * b
+inline std::uint64_t mul_hi64(std::uint64_t a, std::uint64_t b) {
+#if defined(LIBCHESS_HAS_INT128)
+    return std::uint64_t((unsigned __int128)a * b >> 64);
+#elif defined(LIBCHESS_HAS_UMULH)
+    return __umulh(a, b);
+#else
+    return mul_hi64_portable(a, b);
+#endif
+}
+
+// Starts loading the cache line holding address, where the compiler offers a way to
+inline void prefetch(const void* address) {
+#if defined(__GNUC__)
+    __builtin_prefetch(address);
+#elif defined(LIBCHESS_HAS_MM_PREFETCH)
+    _mm_prefetch(static_cast<const char*>(address), _MM_HINT_T0);
+#else
+    (void)address;
+#endif
+}
+
+}  // namespace libchess::intrinsics
+
+#endif  // LIBCHESS_INTRINSICS_H
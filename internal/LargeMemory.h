@@ -0,0 +1,250 @@
+#ifndef LIBCHESS_LARGEMEMORY_H
+#define LIBCHESS_LARGEMEMORY_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <new>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__)
+#define LIBCHESS_HAS_LINUX_MEMORY 1
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#endif
+
+namespace libchess::memory {
+
+// Transparent huge pages on x86-64 and most aarch64 kernels
+constexpr std::size_t HUGE_PAGE_SIZE = std::size_t(2) << 20;
+
+enum class PageKind
+{
+    STANDARD,
+    TRANSPARENT_HUGE,
+    HUGETLB
+};
+
+inline const char* to_str(PageKind page_kind) {
+    switch (page_kind) {
+        case PageKind::STANDARD:
+            return "standard";
+        case PageKind::TRANSPARENT_HUGE:
+            return "transparent huge";
+        case PageKind::HUGETLB:
+            return "hugetlb";
+        default:
+            return "unknown";
+    }
+}
+
+/// Zeroed memory for tables of hundreds of megabytes or more, backed by huge pages when the
+/// system has them, so that random probes miss the TLB far less often. It first asks for
+/// reserved MAP_HUGETLB pages, then for a huge-page aligned mapping advised with MADV_HUGEPAGE,
+/// and off Linux falls back to an aligned heap allocation. The pages of a mapping are only
+/// placed on a NUMA node when first written, see for_each_chunk_interleaved().
+class LargeBuffer {
+   public:
+    LargeBuffer() : data_(nullptr), size_(0), page_kind_(PageKind::STANDARD) {
+    }
+    // Throws std::bad_alloc when no kind of allocation succeeds
+    explicit LargeBuffer(std::size_t size, bool allow_hugetlb = true) : LargeBuffer() {
+        size_ = (std::max<std::size_t>(size, 1) + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE *
+                HUGE_PAGE_SIZE;
+#ifdef LIBCHESS_HAS_LINUX_MEMORY
+        if (allow_hugetlb) {
+            data_ = map(size_, MAP_HUGETLB);
+            if (data_) {
+                page_kind_ = PageKind::HUGETLB;
+                return;
+            }
+        }
+        // Over-map by one huge page and trim, so that every huge page of the buffer is aligned
+        char* raw = static_cast<char*>(map(size_ + HUGE_PAGE_SIZE, 0));
+        if (!raw) {
+            throw std::bad_alloc{};
+        }
+        std::size_t misalignment = std::uintptr_t(raw) % HUGE_PAGE_SIZE;
+        std::size_t head = misalignment ? HUGE_PAGE_SIZE - misalignment : 0;
+        if (head) {
+            ::munmap(raw, head);
+        }
+        ::munmap(raw + head + size_, HUGE_PAGE_SIZE - head);
+        data_ = raw + head;
+        bool advised = ::madvise(data_, size_, MADV_HUGEPAGE) == 0;
+        page_kind_ = advised && transparent_huge_pages_enabled() ? PageKind::TRANSPARENT_HUGE
+                                                                 : PageKind::STANDARD;
+#else
+        (void)allow_hugetlb;
+        data_ = std::aligned_alloc(HUGE_PAGE_SIZE, size_);
+        if (!data_) {
+            throw std::bad_alloc{};
+        }
+        std::memset(data_, 0, size_);
+#endif
+    }
+    LargeBuffer(const LargeBuffer&) = delete;
+    LargeBuffer& operator=(const LargeBuffer&) = delete;
+    LargeBuffer(LargeBuffer&& other) noexcept
+        : data_(std::exchange(other.data_, nullptr)),
+          size_(std::exchange(other.size_, 0)),
+          page_kind_(other.page_kind_) {
+    }
+    LargeBuffer& operator=(LargeBuffer&& other) noexcept {
+        if (this != &other) {
+            release();
+            data_ = std::exchange(other.data_, nullptr);
+            size_ = std::exchange(other.size_, 0);
+            page_kind_ = other.page_kind_;
+        }
+        return *this;
+    }
+    ~LargeBuffer() {
+        release();
+    }
+
+    void* data() const {
+        return data_;
+    }
+    // The requested size rounded up to whole huge pages
+    std::size_t size() const {
+        return size_;
+    }
+    PageKind page_kind() const {
+        return page_kind_;
+    }
+
+   private:
+#ifdef LIBCHESS_HAS_LINUX_MEMORY
+    static void* map(std::size_t size, int extra_flags) {
+        void* data = ::mmap(nullptr,
+                            size,
+                            PROT_READ | PROT_WRITE,
+                            MAP_PRIVATE | MAP_ANONYMOUS | extra_flags,
+                            -1,
+                            0);
+        return data == MAP_FAILED ? nullptr : data;
+    }
+    // madvise succeeds even when the kernel is set to never use transparent huge pages
+    static bool transparent_huge_pages_enabled() {
+        std::ifstream enabled{"/sys/kernel/mm/transparent_hugepage/enabled"};
+        std::string modes;
+        std::getline(enabled, modes);
+        return modes.find("[never]") == std::string::npos;
+    }
+#endif
+
+    void release() {
+        if (!data_) {
+            return;
+        }
+#ifdef LIBCHESS_HAS_LINUX_MEMORY
+        ::munmap(data_, size_);
+#else
+        std::free(data_);
+#endif
+    }
+
+    void* data_;
+    std::size_t size_;
+    PageKind page_kind_;
+};
+
+// The CPUs of each NUMA node, from sysfs. A single entry, with no CPUs listed, when the topology
+// is unknown.
+inline std::vector<std::vector<int>> numa_node_cpus() {
+    std::vector<std::vector<int>> nodes;
+    for (int node = 0;; ++node) {
+        std::string path = "/sys/devices/system/node/node" + std::to_string(node) + "/cpulist";
+        std::ifstream cpulist{path};
+        if (!cpulist) {
+            break;
+        }
+        // Comma-separated CPUs and ranges, e.g. 0-7,16-23
+        std::vector<int> cpus;
+        std::string range;
+        while (std::getline(cpulist, range, ',')) {
+            int first = 0;
+            int last = 0;
+            char dash = 0;
+            std::istringstream range_stream{range};
+            if (!(range_stream >> first)) {
+                continue;
+            }
+            if (!(range_stream >> dash >> last)) {
+                last = first;
+            }
+            for (int cpu = first; cpu <= last; ++cpu) {
+                cpus.push_back(cpu);
+            }
+        }
+        nodes.push_back(std::move(cpus));
+    }
+    if (nodes.empty()) {
+        nodes.emplace_back();
+    }
+    return nodes;
+}
+
+// Pins the calling thread to the CPUs of a node; does nothing if they are unknown
+inline void bind_to_cpus(const std::vector<int>& cpus) {
+#ifdef LIBCHESS_HAS_LINUX_MEMORY
+    if (cpus.empty()) {
+        return;
+    }
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    for (int cpu : cpus) {
+        if (cpu < CPU_SETSIZE) {
+            CPU_SET(cpu, &cpu_set);
+        }
+    }
+    ::pthread_setaffinity_np(::pthread_self(), sizeof(cpu_set), &cpu_set);
+#else
+    (void)cpus;
+#endif
+}
+
+// Calls f(begin, end) on byte ranges covering [0, size), one huge page at a time, from `threads`
+// threads. Page i goes to thread i % threads, and on NUMA systems thread t is pinned to node
+// t % nodes, so the first write to each page, which places it, interleaves a fresh buffer
+// across the nodes.
+template <class F>
+void for_each_chunk_interleaved(std::size_t size, int threads, F f) {
+    std::size_t chunk_count = (size + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE;
+    std::size_t max_threads = std::max<std::size_t>(chunk_count, 1);
+    threads = int(std::min<std::size_t>(std::max(threads, 1), max_threads));
+    std::vector<std::vector<int>> nodes = numa_node_cpus();
+    auto worker = [&](int id) {
+        if (nodes.size() > 1) {
+            bind_to_cpus(nodes[id % nodes.size()]);
+        }
+        for (std::size_t chunk = id; chunk < chunk_count; chunk += threads) {
+            std::size_t begin = chunk * HUGE_PAGE_SIZE;
+            f(begin, std::min(begin + HUGE_PAGE_SIZE, size));
+        }
+    };
+    if (threads == 1 && nodes.size() == 1) {
+        worker(0);
+        return;
+    }
+    std::vector<std::thread> workers;
+    for (int id = 0; id < threads; ++id) {
+        workers.emplace_back(worker, id);
+    }
+    for (auto& thread : workers) {
+        thread.join();
+    }
+}
+
+}  // namespace libchess::memory
+
+#endif  // LIBCHESS_LARGEMEMORY_H
@@ -0,0 +1,78 @@
+#ifndef LIBCHESS_MAGICS_H
+#define LIBCHESS_MAGICS_H
+
+#include <cstdint>
+
+namespace libchess::magics {
+
+constexpr static std::uint64_t bishop_magics[64] = {
+    std::uint64_t(0x10102002004A1420), std::uint64_t(0x8020040400584008),
+    std::uint64_t(0x10510800811201C8), std::uint64_t(0x5204042080000088),
+    std::uint64_t(0x2204106880000002), std::uint64_t(0x1401042004000000),
+    std::uint64_t(0x0400880410042004), std::uint64_t(0x0028208200A02020),
+    std::uint64_t(0x1500241990010E00), std::uint64_t(0x8001200182020A40),
+    std::uint64_t(0x40004101030B0000), std::uint64_t(0x8002041042000100),
+    std::uint64_t(0x4010011041020038), std::uint64_t(0x0000010421044000),
+    std::uint64_t(0x1500210808020A00), std::uint64_t(0x8000088400880520),
+    std::uint64_t(0x0405004010040100), std::uint64_t(0x1005823210040108),
+    std::uint64_t(0x2708008102040011), std::uint64_t(0x4048200404009100),
+    std::uint64_t(0x0018104101400024), std::uint64_t(0x0003000601190101),
+    std::uint64_t(0x8004803108491000), std::uint64_t(0x8014241200820800),
+    std::uint64_t(0x0006E080100C3040), std::uint64_t(0x0501044A11041800),
+    std::uint64_t(0x9020300008004045), std::uint64_t(0x0894080000220040),
+    std::uint64_t(0x1001010083104000), std::uint64_t(0x5004030040900080),
+    std::uint64_t(0x000400422C012400), std::uint64_t(0x0002128698404812),
+    std::uint64_t(0x1010108404900440), std::uint64_t(0x0928021182084100),
+    std::uint64_t(0x2006080409020024), std::uint64_t(0x1010202020180080),
+    std::uint64_t(0xA010008200202200), std::uint64_t(0x2098015100019004),
+    std::uint64_t(0x0002041440810811), std::uint64_t(0x802A02020000B098),
+    std::uint64_t(0x0009015090004060), std::uint64_t(0x4000821082081001),
+    std::uint64_t(0x0100210040420800), std::uint64_t(0x0800004010488A00),
+    std::uint64_t(0x2000081104004040), std::uint64_t(0x4C8E029015000082),
+    std::uint64_t(0x0420340322224842), std::uint64_t(0x1298260043400210),
+    std::uint64_t(0x0000822802400008), std::uint64_t(0x00008A0101600000),
+    std::uint64_t(0x3040003412080021), std::uint64_t(0x3040290220884800),
+    std::uint64_t(0x4A1500401041004A), std::uint64_t(0x8010200282020781),
+    std::uint64_t(0x0020203142209091), std::uint64_t(0x0070300600902110),
+    std::uint64_t(0x0040808800B62048), std::uint64_t(0x0000810400C44420),
+    std::uint64_t(0x00080400440C0441), std::uint64_t(0x8340080020840411),
+    std::uint64_t(0x0000000104208200), std::uint64_t(0x0000800810D00080),
+    std::uint64_t(0x0400530411080200), std::uint64_t(0x4040702400932244)};
+
+constexpr static std::uint64_t rook_magics[64] = {
+    std::uint64_t(0x1080004008801020), std::uint64_t(0x0840092002C03000),
+    std::uint64_t(0x1900200010400900), std::uint64_t(0x0880100008000480),
+    std::uint64_t(0x4200100420080200), std::uint64_t(0x8100020100080400),
+    std::uint64_t(0x0200040110886200), std::uint64_t(0x0200008040220411),
+    std::uint64_t(0x0404800084400220), std::uint64_t(0x0000401000402000),
+    std::uint64_t(0x0086001081220440), std::uint64_t(0x0408800800100280),
+    std::uint64_t(0x000A001201040820), std::uint64_t(0x8848800200840080),
+    std::uint64_t(0x4001000100040200), std::uint64_t(0x0442000102105084),
+    std::uint64_t(0x9080010020804100), std::uint64_t(0x0040404000201009),
+    std::uint64_t(0x0000808010002009), std::uint64_t(0x2200090021D00100),
+    std::uint64_t(0x0008008008040080), std::uint64_t(0x0004004002010040),
+    std::uint64_t(0x0011040008015042), std::uint64_t(0x00000A0001768104),
+    std::uint64_t(0x0000800080204009), std::uint64_t(0x2010004140002001),
+    std::uint64_t(0x9800200280100080), std::uint64_t(0x1000100080080080),
+    std::uint64_t(0x0442000A00049020), std::uint64_t(0x2100040080020080),
+    std::uint64_t(0x0800120400900148), std::uint64_t(0x0010040A00128541),
+    std::uint64_t(0x2800804000800030), std::uint64_t(0x1010002000400041),
+    std::uint64_t(0x4000200011004100), std::uint64_t(0x0610008410800800),
+    std::uint64_t(0x0400802402800800), std::uint64_t(0xC100020080800400),
+    std::uint64_t(0x0002000802000401), std::uint64_t(0x0182085882000401),
+    std::uint64_t(0x0220204000808000), std::uint64_t(0x2860100040024022),
+    std::uint64_t(0x0001002004110040), std::uint64_t(0x99101042000A0020),
+    std::uint64_t(0x0004080004008080), std::uint64_t(0x0010040002008080),
+    std::uint64_t(0x2012004881020004), std::uint64_t(0x8300842444820011),
+    std::uint64_t(0x0088403882010200), std::uint64_t(0x0820400080210100),
+    std::uint64_t(0x0110910040A00300), std::uint64_t(0x0801100280080480),
+    std::uint64_t(0x0242009008200600), std::uint64_t(0x1002000489500200),
+    std::uint64_t(0x0040800200010080), std::uint64_t(0x0091800041000080),
+    std::uint64_t(0x0000209300488001), std::uint64_t(0x04C1002414824001),
+    std::uint64_t(0x020020000B001041), std::uint64_t(0x7000100004200901),
+    std::uint64_t(0x8002002004100802), std::uint64_t(0x30010002084C0007),
+    std::uint64_t(0x0888221800813004), std::uint64_t(0x4000002840840112)};
+
+}  // namespace libchess::magics
+
+#endif  // LIBCHESS_MAGICS_H
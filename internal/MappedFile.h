@@ -0,0 +1,129 @@
+#ifndef LIBCHESS_MAPPEDFILE_H
+#define LIBCHESS_MAPPEDFILE_H
+
+#include <cstddef>
+#include <cstdlib>
+#include <fstream>
+#include <optional>
+#include <string>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define LIBCHESS_HAS_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace libchess {
+
+/// A read-only view of a whole file, released on destruction. Where the system has mmap the file
+/// is mapped, and the pages are shared with the page cache so that several processes loading the
+/// same file share one copy; elsewhere, or if mapping fails, it is read into a heap buffer. Either
+/// way the data starts on a 64-byte boundary.
+class MappedFile {
+   public:
+    static std::optional<MappedFile> open(const std::string& path) {
+#ifdef LIBCHESS_HAS_MMAP
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return std::nullopt;
+        }
+        struct stat file_stat;
+        if (::fstat(fd, &file_stat) != 0 || file_stat.st_size <= 0) {
+            ::close(fd);
+            return std::nullopt;
+        }
+        std::size_t size = std::size_t(file_stat.st_size);
+        void* data = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+        // The mapping keeps its own reference to the file
+        ::close(fd);
+        if (data != MAP_FAILED) {
+            ::madvise(data, size, MADV_WILLNEED);
+            return MappedFile{data, size, true};
+        }
+#endif
+        return read(path);
+    }
+
+    // Reads the whole file into memory instead of mapping it
+    static std::optional<MappedFile> read(const std::string& path) {
+        std::ifstream file{path, std::ios::binary | std::ios::ate};
+        if (!file) {
+            return std::nullopt;
+        }
+        std::streamoff size = file.tellg();
+        if (size <= 0) {
+            return std::nullopt;
+        }
+        // aligned_alloc wants a multiple of the alignment
+        void* data = std::aligned_alloc(64, (std::size_t(size) + 63) / 64 * 64);
+        if (!data) {
+            return std::nullopt;
+        }
+        MappedFile mapped_file{data, std::size_t(size), false};
+        file.seekg(0);
+        if (!file.read(static_cast<char*>(data), size)) {
+            return std::nullopt;
+        }
+        return mapped_file;
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept
+        : data_(std::exchange(other.data_, nullptr)),
+          size_(std::exchange(other.size_, 0)),
+          mapped_(other.mapped_) {
+    }
+    MappedFile& operator=(MappedFile&& other) noexcept {
+        if (this != &other) {
+            release();
+            data_ = std::exchange(other.data_, nullptr);
+            size_ = std::exchange(other.size_, 0);
+            mapped_ = other.mapped_;
+        }
+        return *this;
+    }
+    ~MappedFile() {
+        release();
+    }
+
+    const void* data() const {
+        return data_;
+    }
+    std::size_t size() const {
+        return size_;
+    }
+    // False when the file was read into memory instead
+    bool mapped() const {
+        return mapped_;
+    }
+
+   private:
+    MappedFile(void* data, std::size_t size, bool mapped)
+        : data_(data), size_(size), mapped_(mapped) {
+    }
+
+    void release() {
+        if (!data_) {
+            return;
+        }
+#ifdef LIBCHESS_HAS_MMAP
+        if (mapped_) {
+            ::munmap(data_, size_);
+            return;
+        }
+#endif
+        std::free(data_);
+    }
+
+    void* data_;
+    std::size_t size_;
+    bool mapped_;
+};
+
+}  // namespace libchess
+
+#endif  // LIBCHESS_MAPPEDFILE_H
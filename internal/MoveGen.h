@@ -0,0 +1,641 @@
+#ifndef LIBCHESS_MOVEGEN_H
+#define LIBCHESS_MOVEGEN_H
+
+#include <cstdlib>
+#include <optional>
+
+#include "../Bitboard.h"
+#include "../CastlingRights.h"
+#include "../Color.h"
+#include "../Lookups.h"
+#include "../Move.h"
+#include "../PieceType.h"
+#include "../Square.h"
+
+/// Attacks, move classification, move validation and legal move generation written once for both
+/// board representations, Position and Board. BoardType provides piece_type_bb(), color_bb(),
+/// occupancy_bb(), king_square(), piece_type_on(), side_to_move(), castling_rights() and
+/// enpassant_square(). Check and pin information is passed in, as Position caches it and Board
+/// computes it.
+namespace libchess::movegen {
+
+template <typename BoardType>
+inline Bitboard attackers_to(const BoardType& board, Square square, Bitboard occupancy) {
+    Bitboard attackers;
+    attackers |= lookups::pawn_attacks(square, constants::WHITE) &
+                 board.piece_type_bb(constants::PAWN, constants::BLACK);
+    attackers |= lookups::pawn_attacks(square, constants::BLACK) &
+                 board.piece_type_bb(constants::PAWN, constants::WHITE);
+    for (PieceType pt = constants::KNIGHT; pt <= constants::KING; ++pt) {
+        attackers |=
+            lookups::non_pawn_piece_type_attacks(pt, square, occupancy) & board.piece_type_bb(pt);
+    }
+    return attackers;
+}
+
+template <typename BoardType>
+inline Bitboard attacked_squares(const BoardType& board, Color c, Bitboard occupancy) {
+    Bitboard pawn_bb = board.piece_type_bb(constants::PAWN, c);
+    Bitboard attacked_bb = c == constants::WHITE ? ((pawn_bb & ~lookups::FILE_A_MASK) << 7) |
+                                                       ((pawn_bb & ~lookups::FILE_H_MASK) << 9)
+                                                 : ((pawn_bb & ~lookups::FILE_A_MASK) >> 9) |
+                                                       ((pawn_bb & ~lookups::FILE_H_MASK) >> 7);
+    for (PieceType pt = constants::KNIGHT; pt <= constants::KING; ++pt) {
+        Bitboard piece_bb = board.piece_type_bb(pt, c);
+        while (piece_bb) {
+            attacked_bb |=
+                lookups::non_pawn_piece_type_attacks(pt, piece_bb.forward_bitscan(), occupancy);
+            piece_bb.forward_popbit();
+        }
+    }
+    return attacked_bb;
+}
+
+// Pieces of either color that alone stand between a slider of !c and the king of c
+template <typename BoardType>
+inline Bitboard king_blockers(const BoardType& board, Color c) {
+    Bitboard king_bb = board.piece_type_bb(constants::KING, c);
+    if (!king_bb) {
+        return Bitboard{};
+    }
+    Square king_sq = king_bb.forward_bitscan();
+    Bitboard occupancy = board.occupancy_bb();
+    Bitboard queen_bb = board.piece_type_bb(constants::QUEEN);
+    Bitboard snipers_bb =
+        ((queen_bb | board.piece_type_bb(constants::ROOK)) & lookups::rook_attacks(king_sq)) |
+        ((queen_bb | board.piece_type_bb(constants::BISHOP)) & lookups::bishop_attacks(king_sq));
+    snipers_bb &= board.color_bb(!c);
+    Bitboard blockers;
+    while (snipers_bb) {
+        Square sq = snipers_bb.forward_bitscan();
+        snipers_bb.forward_popbit();
+        Bitboard bb = lookups::intervening(sq, king_sq) & occupancy;
+        if (bb.popcount() == 1) {
+            blockers |= bb;
+        }
+    }
+    return blockers;
+}
+
+// The type of a move, derived from the board when the move does not carry one
+template <typename BoardType>
+inline Move::Type move_type_of(const BoardType& board, Move move) {
+    Move::Type move_type = move.type();
+    if (move_type != Move::Type::NONE) {
+        return move_type;
+    }
+    Square to_square = move.to_square();
+    Square from_square = move.from_square();
+    auto moving_pt = board.piece_type_on(from_square);
+    auto captured_pt = board.piece_type_on(to_square);
+    if (move.promotion_piece_type()) {
+        return captured_pt ? Move::Type::CAPTURE_PROMOTION : Move::Type::PROMOTION;
+    } else if (captured_pt) {
+        return Move::Type::CAPTURE;
+    } else if (moving_pt == constants::PAWN) {
+        int sq_diff = std::abs(to_square - from_square);
+        if (sq_diff == 16) {
+            return Move::Type::DOUBLE_PUSH;
+        } else if (sq_diff == 9 || sq_diff == 7) {
+            return Move::Type::ENPASSANT;
+        } else {
+            return Move::Type::NORMAL;
+        }
+    } else if (moving_pt == constants::KING && std::abs(to_square - from_square) == 2) {
+        return Move::Type::CASTLING;
+    } else {
+        return Move::Type::NORMAL;
+    }
+}
+
+inline bool is_capture_move(Move move) {
+    switch (move.type()) {
+        case Move::Type::CAPTURE:
+        case Move::Type::CAPTURE_PROMOTION:
+        case Move::Type::ENPASSANT:
+            return true;
+        default:
+            return false;
+    }
+}
+
+// King destinations of the castling moves available to stm, which must not be in check
+template <typename BoardType>
+inline Bitboard legal_castling_targets(const BoardType& board,
+                                       Color stm,
+                                       Bitboard occupancy,
+                                       Bitboard king_danger_bb) {
+    const CastlingRight castling_sides[2][2] = {
+        {constants::WHITE_KINGSIDE, constants::WHITE_QUEENSIDE},
+        {constants::BLACK_KINGSIDE, constants::BLACK_QUEENSIDE},
+    };
+    const Square castling_target_sqs[2][2] = {{constants::G1, constants::C1},
+                                              {constants::G8, constants::C8}};
+    const Bitboard castling_empty_masks[2][2] = {
+        {(Bitboard{constants::F1} | Bitboard{constants::G1}),
+         (Bitboard{constants::D1} | Bitboard{constants::C1} | Bitboard{constants::B1})},
+        {(Bitboard{constants::F8} | Bitboard{constants::G8}),
+         (Bitboard{constants::D8} | Bitboard{constants::C8} | Bitboard{constants::B8})}};
+    const Bitboard castling_safe_masks[2][2] = {
+        {(Bitboard{constants::F1} | Bitboard{constants::G1}),
+         (Bitboard{constants::D1} | Bitboard{constants::C1})},
+        {(Bitboard{constants::F8} | Bitboard{constants::G8}),
+         (Bitboard{constants::D8} | Bitboard{constants::C8})}};
+    CastlingRights curr_castling_rights = board.castling_rights();
+    Bitboard targets;
+    for (int side = 0; side < 2; ++side) {
+        if (curr_castling_rights.is_allowed(castling_sides[stm][side]) &&
+            !(castling_empty_masks[stm][side] & occupancy) &&
+            !(castling_safe_masks[stm][side] & king_danger_bb)) {
+            targets |= Bitboard{castling_target_sqs[stm][side]};
+        }
+    }
+    return targets;
+}
+
+// Squares from which a piece of type piece_type and color c would check the king of !c
+template <typename BoardType>
+inline Bitboard check_squares(const BoardType& board, PieceType piece_type, Color c) {
+    Square king_sq = board.king_square(!c);
+    if (piece_type == constants::PAWN) {
+        return lookups::pawn_attacks(king_sq, !c);
+    } else if (piece_type == constants::KING) {
+        return Bitboard{};
+    }
+    return lookups::non_pawn_piece_type_attacks(piece_type, king_sq, board.occupancy_bb());
+}
+
+// Whether a pseudo-legal move of the side to move checks the opposing king, without making the
+// move, given the check squares of the moving piece's type and the pieces of the side to move
+// that block a line to the opposing king
+template <typename BoardType>
+inline bool gives_check(const BoardType& board,
+                        Move move,
+                        Bitboard piece_check_squares,
+                        Bitboard discoverers) {
+    Color stm = board.side_to_move();
+    Square from_sq = move.from_square();
+    Square to_sq = move.to_square();
+    Bitboard from_bb{from_sq};
+    Bitboard to_bb{to_sq};
+    Square opp_king_sq = board.king_square(!stm);
+
+    if (piece_check_squares & to_bb) {
+        return true;
+    }
+    if ((discoverers & from_bb) && !(lookups::full_ray(opp_king_sq, from_sq) & to_bb)) {
+        return true;
+    }
+
+    switch (move_type_of(board, move)) {
+        case Move::Type::PROMOTION:
+        case Move::Type::CAPTURE_PROMOTION:
+            return lookups::non_pawn_piece_type_attacks(
+                       *move.promotion_piece_type(), to_sq, board.occupancy_bb() ^ from_bb) &
+                   Bitboard{opp_king_sq};
+        case Move::Type::ENPASSANT: {
+            // The captured pawn may have been the only piece blocking a slider
+            Bitboard captured_bb{lookups::pawn_shift(to_sq, !stm)};
+            Bitboard occupancy = (board.occupancy_bb() ^ from_bb ^ captured_bb) | to_bb;
+            Bitboard stm_bb = board.color_bb(stm);
+            Bitboard queen_bb = board.piece_type_bb(constants::QUEEN);
+            return (lookups::rook_attacks(opp_king_sq, occupancy) & stm_bb &
+                    (queen_bb | board.piece_type_bb(constants::ROOK))) ||
+                   (lookups::bishop_attacks(opp_king_sq, occupancy) & stm_bb &
+                    (queen_bb | board.piece_type_bb(constants::BISHOP)));
+        }
+        case Move::Type::CASTLING: {
+            bool kingside = to_sq > from_sq;
+            Square rook_from_sq = kingside ? from_sq + 3 : from_sq - 4;
+            Square rook_to_sq = kingside ? from_sq + 1 : from_sq - 1;
+            Bitboard occupancy = (board.occupancy_bb() ^ from_bb ^ Bitboard{rook_from_sq}) |
+                                 to_bb | Bitboard{rook_to_sq};
+            return lookups::rook_attacks(rook_to_sq, occupancy) & Bitboard{opp_king_sq};
+        }
+        default:
+            return false;
+    }
+}
+
+// Validates an arbitrary move of the side to move, such as a TT move or a killer, in constant
+// time: the move shape is checked against the board, then the check and pin masks of
+// visit_legal_moves() are applied to it
+template <typename BoardType>
+inline bool is_legal_move(const BoardType& board, Move move, Bitboard checkers, Bitboard pinned) {
+    Square from_sq = move.from_square();
+    Square to_sq = move.to_square();
+    Color c = board.side_to_move();
+    Bitboard from_bb{from_sq};
+    Bitboard to_bb{to_sq};
+    if (!(board.color_bb(c) & from_bb) || (board.color_bb(c) & to_bb)) {
+        return false;
+    }
+
+    PieceType pt = *board.piece_type_on(from_sq);
+    Bitboard occupancy = board.occupancy_bb();
+    Bitboard opp_occupancy = board.color_bb(!c);
+    Square king_sq = board.king_square(c);
+
+    auto promotion_pt = move.promotion_piece_type();
+    bool reaches_last_rank = lookups::relative_rank(to_sq.rank(), c) == constants::RANK_8;
+    // Rejects promotion fields that no generated move carries, such as a king
+    Move canonical_move = promotion_pt ? Move{from_sq, to_sq, *promotion_pt} : Move{from_sq, to_sq};
+    if (move != canonical_move || (promotion_pt && *promotion_pt > constants::QUEEN)) {
+        return false;
+    }
+    if (bool(promotion_pt) != (pt == constants::PAWN && reaches_last_rank)) {
+        return false;
+    }
+
+    if (pt == constants::KING) {
+        if (lookups::king_attacks(from_sq) & to_bb) {
+            return !(attackers_to(board, to_sq, occupancy ^ from_bb) & opp_occupancy);
+        }
+        const CastlingRight castling_sides[2][2] = {
+            {constants::WHITE_KINGSIDE, constants::WHITE_QUEENSIDE},
+            {constants::BLACK_KINGSIDE, constants::BLACK_QUEENSIDE},
+        };
+        const Square castling_sqs[2][2][3] = {
+            {{constants::E1, constants::F1, constants::G1},
+             {constants::E1, constants::D1, constants::C1}},
+            {{constants::E8, constants::F8, constants::G8},
+             {constants::E8, constants::D8, constants::C8}}};
+        if (checkers || from_sq != castling_sqs[c][0][0]) {
+            return false;
+        }
+        for (int side = 0; side < 2; ++side) {
+            const Square* sqs = castling_sqs[c][side];
+            if (to_sq != sqs[2]) {
+                continue;
+            }
+            // The queenside rook also needs the square next to it empty
+            Bitboard empty_mask = Bitboard{sqs[1]} | Bitboard{sqs[2]};
+            if (side == 1) {
+                empty_mask |= Bitboard{sqs[2] - 1};
+            }
+            return board.castling_rights().is_allowed(castling_sides[c][side]) &&
+                   !(empty_mask & occupancy) &&
+                   !(attackers_to(board, sqs[1], occupancy) & opp_occupancy) &&
+                   !(attackers_to(board, sqs[2], occupancy) & opp_occupancy);
+        }
+        return false;
+    }
+
+    if (checkers.popcount() > 1) {
+        return false;
+    }
+
+    if (pt == constants::PAWN) {
+        auto ep_sq = board.enpassant_square();
+        if (ep_sq && to_sq == *ep_sq) {
+            if (!(lookups::pawn_attacks(from_sq, c) & to_bb)) {
+                return false;
+            }
+            // Two pawns leave their squares at once, so the king is tested on the resulting
+            // board rather than with the check and pin masks
+            Bitboard captured_bb = lookups::pawn_shift(to_bb, !c);
+            Bitboard post_ep_occupancy = (occupancy ^ from_bb ^ captured_bb) | to_bb;
+            return !(attackers_to(board, king_sq, post_ep_occupancy) & opp_occupancy &
+                     ~captured_bb);
+        }
+        Square push_sq = lookups::pawn_shift(from_sq, c);
+        bool is_pseudo_legal = false;
+        if (to_sq == push_sq) {
+            is_pseudo_legal = !(occupancy & to_bb);
+        } else if (lookups::relative_rank(from_sq.rank(), c) == constants::RANK_2 &&
+                   to_sq == lookups::pawn_shift(from_sq, c, 2)) {
+            is_pseudo_legal = !(occupancy & (to_bb | Bitboard{push_sq}));
+        } else {
+            is_pseudo_legal = lookups::pawn_attacks(from_sq, c) & to_bb & opp_occupancy;
+        }
+        if (!is_pseudo_legal) {
+            return false;
+        }
+    } else if (!(lookups::non_pawn_piece_type_attacks(pt, from_sq, occupancy) & to_bb)) {
+        return false;
+    }
+
+    if (checkers &&
+        !(to_bb & (checkers | lookups::intervening(king_sq, checkers.forward_bitscan())))) {
+        return false;
+    }
+    return !(pinned & from_bb) || (to_bb & lookups::full_ray(king_sq, from_sq));
+}
+
+// Walks the legal moves of stm, given the pieces checking its king and its pinned pieces. Check
+// evasions and pins are resolved with masks, so nothing is filtered afterwards. The moves reach
+// the sink a batch at a time, as destination bitboards, through three calls, each returning true
+// to stop the walk:
+//   piece_moves(from, to_bb): king, knight, bishop, rook and queen moves from one square
+//   pawn_moves(to_bb, delta, type): pawns moved by delta squares; type is NORMAL, DOUBLE_PUSH,
+//       CAPTURE or ENPASSANT, and destinations on the last rank are promotions
+//   castling_moves(king_sq, to_bb): castling moves, given by the king's destination
+// In check the king is visited first, as it is the only piece that may move in double check;
+// otherwise it comes last, with castling, so that the attack map both need is only built when the
+// other pieces did not already stop the walk. Returns whether the sink stopped the walk.
+template <typename BoardType, typename Sink>
+inline bool visit_legal_moves(const BoardType& board,
+                              Color stm,
+                              Bitboard checkers,
+                              Bitboard pinned,
+                              Sink& sink) {
+    Square king_sq = board.king_square(stm);
+    Bitboard stm_occupancy = board.color_bb(stm);
+    Bitboard opp_occupancy = board.color_bb(!stm);
+    Bitboard occupancy = stm_occupancy | opp_occupancy;
+
+    Bitboard king_danger_bb;
+    auto visit_king_moves = [&] {
+        // The king is left out of the occupancy so that it cannot step back along a checking ray
+        king_danger_bb = attacked_squares(board, !stm, occupancy ^ Bitboard{king_sq});
+        Bitboard king_targets = lookups::king_attacks(king_sq) & ~stm_occupancy & ~king_danger_bb;
+        return king_targets && sink.piece_moves(king_sq, king_targets);
+    };
+    if (checkers) {
+        if (visit_king_moves()) {
+            return true;
+        }
+        if (checkers.popcount() > 1) {
+            return false;
+        }
+    }
+
+    // Squares that resolve a single check, either by capturing the checker or by blocking it
+    Bitboard check_mask = ~Bitboard{};
+    if (checkers) {
+        check_mask = checkers | lookups::intervening(king_sq, checkers.forward_bitscan());
+    }
+    Bitboard targets = ~stm_occupancy & check_mask;
+
+    // Unpinned pawns move set-wise
+    int up = stm == constants::WHITE ? 8 : -8;
+    Bitboard pawn_bb = board.piece_type_bb(constants::PAWN, stm);
+    Bitboard free_pawns = pawn_bb & ~pinned;
+    Bitboard single_pushes = lookups::pawn_shift(free_pawns, stm) & ~occupancy;
+    Bitboard double_pushes =
+        lookups::pawn_shift(single_pushes & lookups::relative_rank_mask(constants::RANK_3, stm),
+                            stm) &
+        ~occupancy & check_mask;
+    single_pushes &= check_mask;
+    Bitboard west_captures = lookups::pawn_shift(free_pawns & ~lookups::FILE_A_MASK, stm) >> 1;
+    Bitboard east_captures = lookups::pawn_shift(free_pawns & ~lookups::FILE_H_MASK, stm) << 1;
+    west_captures &= opp_occupancy & check_mask;
+    east_captures &= opp_occupancy & check_mask;
+    if ((single_pushes && sink.pawn_moves(single_pushes, up, Move::Type::NORMAL)) ||
+        (double_pushes && sink.pawn_moves(double_pushes, 2 * up, Move::Type::DOUBLE_PUSH)) ||
+        (west_captures && sink.pawn_moves(west_captures, up - 1, Move::Type::CAPTURE)) ||
+        (east_captures && sink.pawn_moves(east_captures, up + 1, Move::Type::CAPTURE))) {
+        return true;
+    }
+
+    // A pinned piece may only move along the line through its king and its pinner
+    Bitboard pinned_pawns = pawn_bb & pinned;
+    while (pinned_pawns) {
+        Square from_sq = pinned_pawns.forward_bitscan();
+        pinned_pawns.forward_popbit();
+        Bitboard allowed = check_mask & lookups::full_ray(king_sq, from_sq);
+        Square push_sq = lookups::pawn_shift(from_sq, stm);
+        if (!(occupancy & Bitboard{push_sq})) {
+            if ((allowed & Bitboard{push_sq}) &&
+                sink.pawn_moves(Bitboard{push_sq}, up, Move::Type::NORMAL)) {
+                return true;
+            }
+            Square double_push_sq = lookups::pawn_shift(from_sq, stm, 2);
+            if ((Bitboard{from_sq} & lookups::relative_rank_mask(constants::RANK_2, stm)) &&
+                !(occupancy & Bitboard{double_push_sq}) && (allowed & Bitboard{double_push_sq}) &&
+                sink.pawn_moves(Bitboard{double_push_sq}, 2 * up, Move::Type::DOUBLE_PUSH)) {
+                return true;
+            }
+        }
+        Bitboard captures = lookups::pawn_attacks(from_sq, stm) & opp_occupancy & allowed;
+        while (captures) {
+            Square to_sq = captures.forward_bitscan();
+            captures.forward_popbit();
+            if (sink.pawn_moves(Bitboard{to_sq}, to_sq - from_sq, Move::Type::CAPTURE)) {
+                return true;
+            }
+        }
+    }
+
+    auto ep_sq = board.enpassant_square();
+    if (ep_sq) {
+        Bitboard ep_bb{*ep_sq};
+        Bitboard captured_bb = lookups::pawn_shift(ep_bb, !stm);
+        Bitboard ep_candidates = pawn_bb & lookups::pawn_attacks(*ep_sq, !stm);
+        Bitboard rook_queen_bb =
+            (board.piece_type_bb(constants::ROOK) | board.piece_type_bb(constants::QUEEN)) &
+            opp_occupancy;
+        Bitboard bishop_queen_bb =
+            (board.piece_type_bb(constants::BISHOP) | board.piece_type_bb(constants::QUEEN)) &
+            opp_occupancy;
+        if (!((ep_bb | captured_bb) & check_mask)) {
+            ep_candidates = Bitboard{};
+        }
+        while (ep_candidates) {
+            Square from_sq = ep_candidates.forward_bitscan();
+            ep_candidates.forward_popbit();
+            // Two pawns leave the same rank at once, so pins are checked on the resulting
+            // occupancy rather than with the pin masks
+            Bitboard post_ep_occupancy = (occupancy ^ Bitboard{from_sq} ^ captured_bb) | ep_bb;
+            if (!(lookups::rook_attacks(king_sq, post_ep_occupancy) & rook_queen_bb) &&
+                !(lookups::bishop_attacks(king_sq, post_ep_occupancy) & bishop_queen_bb) &&
+                sink.pawn_moves(ep_bb, *ep_sq - from_sq, Move::Type::ENPASSANT)) {
+                return true;
+            }
+        }
+    }
+
+    for (PieceType pt = constants::KNIGHT; pt <= constants::QUEEN; ++pt) {
+        Bitboard piece_bb = board.piece_type_bb(pt, stm);
+        while (piece_bb) {
+            Square from_sq = piece_bb.forward_bitscan();
+            piece_bb.forward_popbit();
+            Bitboard to_bb =
+                lookups::non_pawn_piece_type_attacks(pt, from_sq, occupancy) & targets;
+            if (pinned & Bitboard{from_sq}) {
+                to_bb &= lookups::full_ray(king_sq, from_sq);
+            }
+            if (to_bb && sink.piece_moves(from_sq, to_bb)) {
+                return true;
+            }
+        }
+    }
+
+    if (checkers) {
+        return false;
+    }
+    if (visit_king_moves()) {
+        return true;
+    }
+    Bitboard castling_targets = legal_castling_targets(board, stm, occupancy, king_danger_bb);
+    return castling_targets && sink.castling_moves(king_sq, castling_targets);
+}
+
+// Builds the moves visit_legal_moves() walks into a MoveList
+class MoveListSink {
+   public:
+    MoveListSink(MoveList& move_list, Color stm, Bitboard enemies)
+        : move_list_(move_list),
+          enemies_(enemies),
+          promotion_mask_(lookups::relative_rank_mask(constants::RANK_8, stm)) {
+    }
+
+    bool piece_moves(Square from_sq, Bitboard to_bb) {
+        while (to_bb) {
+            Square to_sq = to_bb.forward_bitscan();
+            to_bb.forward_popbit();
+            move_list_.add(Move{from_sq,
+                                to_sq,
+                                (enemies_ & Bitboard{to_sq}) ? Move::Type::CAPTURE
+                                                             : Move::Type::NORMAL});
+        }
+        return false;
+    }
+    bool pawn_moves(Bitboard to_bb, int delta, Move::Type type) {
+        Bitboard promotions = to_bb & promotion_mask_;
+        to_bb &= ~promotion_mask_;
+        while (to_bb) {
+            Square to_sq = to_bb.forward_bitscan();
+            to_bb.forward_popbit();
+            move_list_.add(Move{to_sq - delta, to_sq, type});
+        }
+        Move::Type promotion_type =
+            type == Move::Type::CAPTURE ? Move::Type::CAPTURE_PROMOTION : Move::Type::PROMOTION;
+        while (promotions) {
+            Square to_sq = promotions.forward_bitscan();
+            promotions.forward_popbit();
+            Square from_sq = to_sq - delta;
+            move_list_.add(Move{from_sq, to_sq, constants::QUEEN, promotion_type});
+            move_list_.add(Move{from_sq, to_sq, constants::KNIGHT, promotion_type});
+            move_list_.add(Move{from_sq, to_sq, constants::ROOK, promotion_type});
+            move_list_.add(Move{from_sq, to_sq, constants::BISHOP, promotion_type});
+        }
+        return false;
+    }
+    bool castling_moves(Square king_sq, Bitboard to_bb) {
+        while (to_bb) {
+            move_list_.add(Move{king_sq, to_bb.forward_bitscan(), Move::Type::CASTLING});
+            to_bb.forward_popbit();
+        }
+        return false;
+    }
+
+   private:
+    MoveList& move_list_;
+    Bitboard enemies_;
+    Bitboard promotion_mask_;
+};
+
+// Counts the moves visit_legal_moves() walks by popcounting, with a promotion counting as four
+class MoveCountSink {
+   public:
+    explicit MoveCountSink(Color stm)
+        : promotion_mask_(lookups::relative_rank_mask(constants::RANK_8, stm)) {
+    }
+
+    bool piece_moves(Square, Bitboard to_bb) {
+        count_ += to_bb.popcount();
+        return false;
+    }
+    bool pawn_moves(Bitboard to_bb, int, Move::Type) {
+        count_ += to_bb.popcount() + 3 * (to_bb & promotion_mask_).popcount();
+        return false;
+    }
+    bool castling_moves(Square, Bitboard to_bb) {
+        count_ += to_bb.popcount();
+        return false;
+    }
+
+    int count() const {
+        return count_;
+    }
+
+   private:
+    Bitboard promotion_mask_;
+    int count_ = 0;
+};
+
+// Stops the walk of visit_legal_moves() at the first legal move
+class MoveExistsSink {
+   public:
+    bool piece_moves(Square, Bitboard) {
+        return true;
+    }
+    bool pawn_moves(Bitboard, int, Move::Type) {
+        return true;
+    }
+    bool castling_moves(Square, Bitboard) {
+        return true;
+    }
+};
+
+// Passes on only the captures or only the quiet moves of a walk to another sink, in the same split
+// as is_capture_move(): en passant and capture promotions are captures, quiet promotions and
+// castling are quiet moves
+template <typename Sink>
+class CaptureFilterSink {
+   public:
+    CaptureFilterSink(Sink& sink, Bitboard enemies, bool captures)
+        : sink_(sink), enemies_(enemies), captures_(captures) {
+    }
+
+    bool piece_moves(Square from_sq, Bitboard to_bb) {
+        to_bb &= captures_ ? enemies_ : ~enemies_;
+        return to_bb && sink_.piece_moves(from_sq, to_bb);
+    }
+    bool pawn_moves(Bitboard to_bb, int delta, Move::Type type) {
+        bool is_capture = type == Move::Type::CAPTURE || type == Move::Type::ENPASSANT;
+        return is_capture == captures_ && sink_.pawn_moves(to_bb, delta, type);
+    }
+    bool castling_moves(Square king_sq, Bitboard to_bb) {
+        return !captures_ && sink_.castling_moves(king_sq, to_bb);
+    }
+
+   private:
+    Sink& sink_;
+    Bitboard enemies_;
+    bool captures_;
+};
+
+// Appends the legal moves of stm to move_list
+template <typename BoardType>
+inline void generate_legal_moves(const BoardType& board,
+                                 MoveList& move_list,
+                                 Color stm,
+                                 Bitboard checkers,
+                                 Bitboard pinned) {
+    MoveListSink sink{move_list, stm, board.color_bb(!stm)};
+    visit_legal_moves(board, stm, checkers, pinned, sink);
+}
+
+// Appends the legal captures of stm to move_list, or its legal quiet moves
+template <typename BoardType>
+inline void generate_legal_moves(const BoardType& board,
+                                 MoveList& move_list,
+                                 Color stm,
+                                 Bitboard checkers,
+                                 Bitboard pinned,
+                                 bool captures) {
+    MoveListSink list_sink{move_list, stm, board.color_bb(!stm)};
+    CaptureFilterSink<MoveListSink> sink{list_sink, board.color_bb(!stm), captures};
+    visit_legal_moves(board, stm, checkers, pinned, sink);
+}
+
+// The number of moves generate_legal_moves() would produce, without building any of them
+template <typename BoardType>
+inline int legal_move_count(const BoardType& board, Color stm, Bitboard checkers, Bitboard pinned) {
+    MoveCountSink sink{stm};
+    visit_legal_moves(board, stm, checkers, pinned, sink);
+    return sink.count();
+}
+
+// Whether stm has a legal move, stopping at the first one found
+template <typename BoardType>
+inline bool has_legal_move(const BoardType& board, Color stm, Bitboard checkers, Bitboard pinned) {
+    MoveExistsSink sink;
+    return visit_legal_moves(board, stm, checkers, pinned, sink);
+}
+
+}  // namespace libchess::movegen
+
+#endif  // LIBCHESS_MOVEGEN_H
@@ -0,0 +1,72 @@
+#ifndef LIBCHESS_NNUEACCUMULATOR_H
+#define LIBCHESS_NNUEACCUMULATOR_H
+
+#include <cstdint>
+
+#include "../Color.h"
+#include "../Piece.h"
+#include "../PieceType.h"
+#include "../Square.h"
+
+namespace libchess::nnue {
+
+// HalfKP: for each perspective, every non-king piece on its square, relative to that side's own
+// king. Both the king square and the piece square are flipped vertically for black.
+constexpr int PIECE_FEATURES = 10 * 64;
+constexpr int INPUT_DIMENSIONS = 64 * PIECE_FEATURES;
+constexpr int HALF_DIMENSIONS = 256;
+
+constexpr inline int feature_index(Color perspective,
+                                   Square king_square,
+                                   Square square,
+                                   PieceType piece_type,
+                                   Color color) {
+    if (perspective == constants::BLACK) {
+        king_square = king_square.flipped();
+        square = square.flipped();
+    }
+    int piece_index = piece_type.value() * 2 + (color != perspective);
+    return king_square.value() * PIECE_FEATURES + piece_index * 64 + square.value();
+}
+
+/// Feature transformer sums for both perspectives, indexed by color
+struct alignas(64) Accumulator {
+    std::int16_t values[2][HALF_DIMENSIONS];
+};
+
+// A piece a move took from one square to another, or only removed or put on the board, with
+// NO_SQUARE for the missing end
+struct DirtyPiece {
+    constexpr static std::uint8_t NO_SQUARE = 64;
+
+    std::uint8_t piece;
+    std::uint8_t from_square;
+    std::uint8_t to_square;
+};
+
+/// One ply of Position's accumulator stack. A move only records the pieces it changed; the
+/// accumulator is brought up to date from the ply before when an evaluation needs it, or rebuilt
+/// for a perspective whose king has moved since.
+struct AccumulatorState {
+    Accumulator accumulator;
+    DirtyPiece dirty_pieces[3];
+    std::uint8_t dirty_count;
+    bool computed[2];
+    bool needs_refresh[2];
+
+    void reset(bool refresh) {
+        dirty_count = 0;
+        for (int perspective = 0; perspective < 2; ++perspective) {
+            computed[perspective] = false;
+            needs_refresh[perspective] = refresh;
+        }
+    }
+    void add_dirty_piece(Piece piece, std::uint8_t from_square, std::uint8_t to_square) {
+        dirty_pieces[dirty_count++] = DirtyPiece{
+            std::uint8_t(piece.value()), from_square, to_square};
+    }
+};
+
+}  // namespace libchess::nnue
+
+#endif  // LIBCHESS_NNUEACCUMULATOR_H
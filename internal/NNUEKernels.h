@@ -0,0 +1,215 @@
+#ifndef LIBCHESS_NNUEKERNELS_H
+#define LIBCHESS_NNUEKERNELS_H
+
+#include <algorithm>
+#include <cstdint>
+
+#include "CpuFeatures.h"
+
+namespace libchess::nnue {
+
+enum class Kernel
+{
+    SCALAR,
+    SSE41,
+    AVX2
+};
+
+inline const char* to_str(Kernel kernel) {
+    switch (kernel) {
+        case Kernel::SCALAR:
+            return "scalar";
+        case Kernel::SSE41:
+            return "sse4.1";
+        case Kernel::AVX2:
+            return "avx2";
+        default:
+            return "unknown";
+    }
+}
+
+namespace kernels {
+
+// Every kernel works on whole blocks of 32 values, and all backends give identical results: the
+// accumulator arithmetic wraps the same way and the int8 products cannot saturate, since the
+// inputs are clipped to [0, 127].
+
+namespace scalar {
+
+inline void add_row(std::int16_t* acc, const std::int16_t* row, int n) {
+    for (int i = 0; i < n; ++i) {
+        acc[i] = std::int16_t(acc[i] + row[i]);
+    }
+}
+inline void sub_row(std::int16_t* acc, const std::int16_t* row, int n) {
+    for (int i = 0; i < n; ++i) {
+        acc[i] = std::int16_t(acc[i] - row[i]);
+    }
+}
+inline void clipped_relu(const std::int16_t* in, std::uint8_t* out, int n) {
+    for (int i = 0; i < n; ++i) {
+        out[i] = std::uint8_t(std::clamp<int>(in[i], 0, 127));
+    }
+}
+inline std::int32_t dot(const std::uint8_t* in, const std::int8_t* row, int n) {
+    std::int32_t sum = 0;
+    for (int i = 0; i < n; ++i) {
+        sum += in[i] * row[i];
+    }
+    return sum;
+}
+
+}  // namespace scalar
+
+#ifdef LIBCHESS_HAS_X86_SIMD
+namespace sse41 {
+
+__attribute__((target("sse4.1"))) inline void add_row(std::int16_t* acc,
+                                                      const std::int16_t* row,
+                                                      int n) {
+    for (int i = 0; i < n; i += 8) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(acc + i));
+        __m128i r = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(acc + i), _mm_add_epi16(a, r));
+    }
+}
+__attribute__((target("sse4.1"))) inline void sub_row(std::int16_t* acc,
+                                                      const std::int16_t* row,
+                                                      int n) {
+    for (int i = 0; i < n; i += 8) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(acc + i));
+        __m128i r = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(acc + i), _mm_sub_epi16(a, r));
+    }
+}
+__attribute__((target("sse4.1"))) inline void clipped_relu(const std::int16_t* in,
+                                                           std::uint8_t* out,
+                                                           int n) {
+    for (int i = 0; i < n; i += 16) {
+        __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i + 8));
+        __m128i packed = _mm_max_epi8(_mm_packs_epi16(lo, hi), _mm_setzero_si128());
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), packed);
+    }
+}
+__attribute__((target("sse4.1"))) inline std::int32_t dot(const std::uint8_t* in,
+                                                          const std::int8_t* row,
+                                                          int n) {
+    __m128i ones = _mm_set1_epi16(1);
+    __m128i sum = _mm_setzero_si128();
+    for (int i = 0; i < n; i += 16) {
+        __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        __m128i w = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + i));
+        sum = _mm_add_epi32(sum, _mm_madd_epi16(_mm_maddubs_epi16(x, w), ones));
+    }
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0x4e));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0xb1));
+    return _mm_cvtsi128_si32(sum);
+}
+
+}  // namespace sse41
+
+namespace avx2 {
+
+__attribute__((target("avx2"))) inline void add_row(std::int16_t* acc,
+                                                    const std::int16_t* row,
+                                                    int n) {
+    for (int i = 0; i < n; i += 16) {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(acc + i));
+        __m256i r = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(acc + i), _mm256_add_epi16(a, r));
+    }
+}
+__attribute__((target("avx2"))) inline void sub_row(std::int16_t* acc,
+                                                    const std::int16_t* row,
+                                                    int n) {
+    for (int i = 0; i < n; i += 16) {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(acc + i));
+        __m256i r = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(acc + i), _mm256_sub_epi16(a, r));
+    }
+}
+__attribute__((target("avx2"))) inline void clipped_relu(const std::int16_t* in,
+                                                         std::uint8_t* out,
+                                                         int n) {
+    for (int i = 0; i < n; i += 32) {
+        __m256i lo = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+        __m256i hi = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i + 16));
+        // packs works within 128-bit lanes, so the quadwords come out as 0, 2, 1, 3
+        __m256i packed = _mm256_max_epi8(_mm256_packs_epi16(lo, hi), _mm256_setzero_si256());
+        packed = _mm256_permute4x64_epi64(packed, 0xd8);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), packed);
+    }
+}
+__attribute__((target("avx2"))) inline std::int32_t dot(const std::uint8_t* in,
+                                                        const std::int8_t* row,
+                                                        int n) {
+    __m256i ones = _mm256_set1_epi16(1);
+    __m256i sum = _mm256_setzero_si256();
+    for (int i = 0; i < n; i += 32) {
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+        __m256i w = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row + i));
+        sum = _mm256_add_epi32(sum, _mm256_madd_epi16(_mm256_maddubs_epi16(x, w), ones));
+    }
+    __m128i sum128 = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+    sum128 = _mm_add_epi32(sum128, _mm_shuffle_epi32(sum128, 0x4e));
+    sum128 = _mm_add_epi32(sum128, _mm_shuffle_epi32(sum128, 0xb1));
+    return _mm_cvtsi128_si32(sum128);
+}
+
+}  // namespace avx2
+#endif
+
+inline bool is_supported(Kernel kernel) {
+    switch (kernel) {
+        case Kernel::SCALAR:
+            return true;
+        case Kernel::SSE41:
+            return cpu::supports_sse41();
+        case Kernel::AVX2:
+            return cpu::supports_avx2();
+        default:
+            return false;
+    }
+}
+inline Kernel best_supported_kernel() {
+    if (cpu::supports_avx2()) {
+        return Kernel::AVX2;
+    }
+    return cpu::supports_sse41() ? Kernel::SSE41 : Kernel::SCALAR;
+}
+
+#ifdef LIBCHESS_HAS_X86_SIMD
+#define LIBCHESS_NNUE_DISPATCH(kernel, function, ...) \
+    switch (kernel) {                                 \
+        case Kernel::AVX2:                            \
+            return avx2::function(__VA_ARGS__);       \
+        case Kernel::SSE41:                           \
+            return sse41::function(__VA_ARGS__);      \
+        default:                                      \
+            return scalar::function(__VA_ARGS__);     \
+    }
+#else
+#define LIBCHESS_NNUE_DISPATCH(kernel, function, ...) return scalar::function(__VA_ARGS__);
+#endif
+
+inline void add_row(Kernel kernel, std::int16_t* acc, const std::int16_t* row, int n) {
+    LIBCHESS_NNUE_DISPATCH(kernel, add_row, acc, row, n)
+}
+inline void sub_row(Kernel kernel, std::int16_t* acc, const std::int16_t* row, int n) {
+    LIBCHESS_NNUE_DISPATCH(kernel, sub_row, acc, row, n)
+}
+inline void clipped_relu(Kernel kernel, const std::int16_t* in, std::uint8_t* out, int n) {
+    LIBCHESS_NNUE_DISPATCH(kernel, clipped_relu, in, out, n)
+}
+inline std::int32_t dot(Kernel kernel, const std::uint8_t* in, const std::int8_t* row, int n) {
+    LIBCHESS_NNUE_DISPATCH(kernel, dot, in, row, n)
+}
+
+#undef LIBCHESS_NNUE_DISPATCH
+
+}  // namespace kernels
+
+}  // namespace libchess::nnue
+
+#endif  // LIBCHESS_NNUEKERNELS_H
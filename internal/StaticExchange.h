@@ -0,0 +1,260 @@
+#ifndef LIBCHESS_STATICEXCHANGE_H
+#define LIBCHESS_STATICEXCHANGE_H
+
+#include <algorithm>
+#include <array>
+#include <optional>
+
+#include "../Bitboard.h"
+#include "../Color.h"
+#include "../Lookups.h"
+#include "../Move.h"
+#include "../PieceType.h"
+#include "../Square.h"
+#include "MoveGen.h"
+
+namespace libchess {
+
+namespace constants {
+
+constexpr static std::array<int, 6> SEE_PIECE_VALUES = {100, 300, 300, 500, 900, 0};
+
+}  // namespace constants
+
+/// Static exchange evaluation written once for Position and Board. It only reads the bitboards,
+/// the side to move and the en passant square, so it never copies or modifies the board.
+namespace movegen {
+
+// The capture of the side to move onto square with its least valuable attacker
+template <typename BoardType>
+inline std::optional<Move> smallest_capture_move_to(const BoardType& board, Square square) {
+    Color stm = board.side_to_move();
+    Bitboard pawn_attackers_bb =
+        lookups::pawn_attacks(square, !stm) & board.piece_type_bb(constants::PAWN, stm);
+    if (pawn_attackers_bb) {
+        Square from_square = pawn_attackers_bb.forward_bitscan();
+        auto enpassant_sq = board.enpassant_square();
+        if (enpassant_sq && *enpassant_sq == square) {
+            return Move{from_square, square, Move::Type::ENPASSANT};
+        }
+        if (lookups::relative_rank(square.rank(), stm) == constants::RANK_8) {
+            return Move{from_square, square, constants::QUEEN, Move::Type::CAPTURE_PROMOTION};
+        }
+        return Move{from_square, square, Move::Type::CAPTURE};
+    }
+
+    auto piece_types_iter = constants::PIECE_TYPES + 1;
+    auto piece_types_end = constants::PIECE_TYPES + 6;
+    for (; piece_types_iter != piece_types_end; ++piece_types_iter) {
+        Bitboard attackers_bb =
+            lookups::non_pawn_piece_type_attacks(*piece_types_iter, square, board.occupancy_bb()) &
+            board.piece_type_bb(*piece_types_iter, stm);
+        if (attackers_bb) {
+            return Move{attackers_bb.forward_bitscan(), square, Move::Type::CAPTURE};
+        }
+    }
+
+    return std::nullopt;
+}
+
+// Swap-list exchange on the move's target square, with the move itself forced and every later
+// capture optional
+template <typename BoardType>
+inline int see_exchange(const BoardType& board,
+                        Move move,
+                        const std::array<int, 6>& piece_values) {
+    Square from_square = move.from_square();
+    Square to_square = move.to_square();
+    Move::Type move_type = move_type_of(board, move);
+    if (move_type == Move::Type::CASTLING) {
+        return 0;
+    }
+
+    int pawn_value = piece_values[constants::PAWN.value()];
+    int promotion_bonus = piece_values[constants::QUEEN.value()] - pawn_value;
+    bool to_promotion_rank = to_square.rank() == constants::RANK_1 ||
+                             to_square.rank() == constants::RANK_8;
+
+    // gain[d] is the score of the side making the d-th capture if the exchange stopped there
+    int gain[32];
+    int depth = 0;
+    Bitboard occupancy = board.occupancy_bb() ^ Bitboard{from_square};
+    if (move_type == Move::Type::ENPASSANT) {
+        gain[0] = pawn_value;
+        occupancy ^= Bitboard{lookups::pawn_shift(to_square, !board.side_to_move())};
+    } else {
+        auto captured_pt = board.piece_type_on(to_square);
+        gain[0] = captured_pt ? piece_values[captured_pt->value()] : 0;
+    }
+    int on_square_value = piece_values[board.piece_type_on(from_square)->value()];
+    auto promotion_pt = move.promotion_piece_type();
+    if (promotion_pt) {
+        gain[0] += piece_values[promotion_pt->value()] - pawn_value;
+        on_square_value = piece_values[promotion_pt->value()];
+    }
+
+    Color c = board.side_to_move();
+    while (depth < 31) {
+        c = !c;
+        // Recomputing the attackers on the reduced occupancy reveals x-rays behind the pieces
+        // that have already captured
+        Bitboard attackers = attackers_to(board, to_square, occupancy) & occupancy;
+        Bitboard side_attackers = attackers & board.color_bb(c);
+        if (!side_attackers) {
+            break;
+        }
+        PieceType attacker_pt = constants::PAWN;
+        Bitboard attacker_bb;
+        for (PieceType pt : constants::PIECE_TYPES) {
+            attacker_bb = side_attackers & board.piece_type_bb(pt);
+            if (attacker_bb) {
+                attacker_pt = pt;
+                break;
+            }
+        }
+        if (attacker_pt == constants::KING && (attackers & board.color_bb(!c))) {
+            break;
+        }
+
+        ++depth;
+        gain[depth] = on_square_value - gain[depth - 1];
+        on_square_value = piece_values[attacker_pt.value()];
+        if (attacker_pt == constants::PAWN && to_promotion_rank) {
+            gain[depth] += promotion_bonus;
+            on_square_value = piece_values[constants::QUEEN.value()];
+        }
+        occupancy ^= Bitboard{attacker_bb.forward_bitscan()};
+    }
+
+    // Each side may stop capturing once continuing no longer pays
+    for (; depth > 0; --depth) {
+        gain[depth - 1] = -std::max(-gain[depth - 1], gain[depth]);
+    }
+    return gain[0];
+}
+
+template <typename BoardType>
+inline int see_to(const BoardType& board, Square square, const std::array<int, 6>& piece_values) {
+    auto smallest_capture_move = smallest_capture_move_to(board, square);
+    if (!smallest_capture_move) {
+        return 0;
+    }
+    if (!(board.occupancy_bb() & Bitboard{square}) &&
+        smallest_capture_move->type() != Move::Type::ENPASSANT) {
+        return 0;
+    }
+    return std::max(0, see_exchange(board, *smallest_capture_move, piece_values));
+}
+
+template <typename BoardType>
+inline int see_for(const BoardType& board, Move move, const std::array<int, 6>& piece_values) {
+    if (!(board.occupancy_bb() & Bitboard{move.to_square()}) &&
+        move_type_of(board, move) != Move::Type::ENPASSANT) {
+        return 0;
+    }
+    return std::max(0, see_exchange(board, move, piece_values));
+}
+
+// Whether move wins at least threshold in the exchange see_exchange() plays out, without building
+// the whole swap list
+template <typename BoardType>
+inline bool see_ge(const BoardType& board,
+                   Move move,
+                   int threshold,
+                   const std::array<int, 6>& piece_values) {
+    Square from_square = move.from_square();
+    Square to_square = move.to_square();
+    Move::Type move_type = move_type_of(board, move);
+    if (move_type == Move::Type::CASTLING) {
+        return threshold <= 0;
+    }
+
+    int pawn_value = piece_values[constants::PAWN.value()];
+    int promotion_bonus = piece_values[constants::QUEEN.value()] - pawn_value;
+    bool to_promotion_rank = to_square.rank() == constants::RANK_1 ||
+                             to_square.rank() == constants::RANK_8;
+
+    // The outcome over the threshold for the side that captured last if the exchange stopped
+    // here. A side wins the exchange when its balance is not negative; the other side's balance
+    // is -balance - 1, so that a tie goes to the side that moved first.
+    int balance = -threshold;
+    Bitboard occupancy = board.occupancy_bb() ^ Bitboard{from_square};
+    if (move_type == Move::Type::ENPASSANT) {
+        balance += pawn_value;
+        occupancy ^= Bitboard{lookups::pawn_shift(to_square, !board.side_to_move())};
+    } else if (auto captured_pt = board.piece_type_on(to_square)) {
+        balance += piece_values[captured_pt->value()];
+    }
+    int on_square_value = piece_values[board.piece_type_on(from_square)->value()];
+    auto promotion_pt = move.promotion_piece_type();
+    if (promotion_pt) {
+        balance += piece_values[promotion_pt->value()] - pawn_value;
+        on_square_value = piece_values[promotion_pt->value()];
+    }
+    // Recaptures can only lower the outcome
+    if (balance < 0) {
+        return false;
+    }
+    // Nor can they lower it by more than the first recapture takes
+    if (balance - on_square_value - (to_promotion_rank ? promotion_bonus : 0) >= 0) {
+        return true;
+    }
+
+    Bitboard diagonal_sliders =
+        board.piece_type_bb(constants::BISHOP) | board.piece_type_bb(constants::QUEEN);
+    Bitboard straight_sliders =
+        board.piece_type_bb(constants::ROOK) | board.piece_type_bb(constants::QUEEN);
+    Bitboard attackers = attackers_to(board, to_square, occupancy) & occupancy;
+    Color last = board.side_to_move();
+    while (true) {
+        Color c = !last;
+        Bitboard side_attackers = attackers & board.color_bb(c);
+        if (!side_attackers) {
+            break;
+        }
+        PieceType attacker_pt = constants::PAWN;
+        Bitboard attacker_bb;
+        for (PieceType pt : constants::PIECE_TYPES) {
+            attacker_bb = side_attackers & board.piece_type_bb(pt);
+            if (attacker_bb) {
+                attacker_pt = pt;
+                break;
+            }
+        }
+        // Moving a piece off the line to the square reveals the slider behind it, if any
+        occupancy ^= Bitboard{attacker_bb.forward_bitscan()};
+        if (attacker_pt != constants::KNIGHT && attacker_pt != constants::ROOK) {
+            attackers |= lookups::bishop_attacks(to_square, occupancy) & diagonal_sliders;
+        }
+        if (attacker_pt == constants::ROOK || attacker_pt == constants::QUEEN ||
+            attacker_pt == constants::KING) {
+            attackers |= lookups::rook_attacks(to_square, occupancy) & straight_sliders;
+        }
+        attackers &= occupancy;
+        // The king may only capture when nothing can recapture
+        if (attacker_pt == constants::KING && (attackers & board.color_bb(!c))) {
+            break;
+        }
+
+        int gain = on_square_value;
+        on_square_value = piece_values[attacker_pt.value()];
+        if (attacker_pt == constants::PAWN && to_promotion_rank) {
+            gain += promotion_bonus;
+            on_square_value = piece_values[constants::QUEEN.value()];
+        }
+        // The side that captured last keeps the exchange if it can stand this recapture
+        if (balance - gain >= 0) {
+            break;
+        }
+        // Otherwise the recapture wins it for now, and it is the other side's turn to answer
+        balance = gain - balance - 1;
+        last = c;
+    }
+    return last == board.side_to_move();
+}
+
+}  // namespace movegen
+
+}  // namespace libchess
+
+#endif  // LIBCHESS_STATICEXCHANGE_H
@@ -13,6 +13,11 @@ constexpr inline std::uint64_t piece_square_key(Square square, PieceType piece_t
     int piece_offset = piece_type.value() * 2 + (color == constants::WHITE);
     return polyglot::random_u64[piece_offset * 64 + square.value()];
 }
+// Material keys reuse the piece-square keys with the piece count in place of the square; a
+// material key is the XOR of the keys of counts 0 to n - 1 for each piece with n on the board
+constexpr inline std::uint64_t material_key(PieceType piece_type, Color color, int count) {
+    return piece_square_key(Square{count}, piece_type, color);
+}
 constexpr inline std::uint64_t castling_rights_key(CastlingRights castling_rights) {
     std::uint64_t hash = 0;
     if (castling_rights.is_allowed(constants::WHITE_KINGSIDE)) {
@@ -1,35 +1,357 @@
+#include <atomic>
 #include <chrono>
+#include <deque>
 #include <fstream>
 #include <iomanip>
+#include <memory>
+#include <mutex>
+#include <optional>
 #include <string>
 #include <string_view>
+#include <thread>
+#include <vector>
 
 #include "../Position.h"
+#include "../internal/LargeMemory.h"
 
 using namespace libchess;
 using namespace constants;
 
-inline long long int perft(Position& pos, int depth) {
+// Counts of (hash, depth) pairs shared by all perft threads without locks. Each entry keeps the key
+// XORed with its data, so an entry torn by two concurrent writers fails verification and is
+// treated as a miss. The entries live on huge pages where the system allows, first written by
+// the perft threads so that they interleave across NUMA nodes.
+class PerftTable {
+   public:
+    PerftTable(std::size_t megabytes, int threads) {
+        std::size_t max_entries = (megabytes << 20) / sizeof(Entry);
+        std::size_t entry_count = 1;
+        while (entry_count * 2 <= max_entries) {
+            entry_count *= 2;
+        }
+        buffer_ = memory::LargeBuffer{entry_count * sizeof(Entry)};
+        entries_ = static_cast<Entry*>(buffer_.data());
+        mask_ = entry_count - 1;
+        // Constructing the entries is their first write, which places each page
+        memory::for_each_chunk_interleaved(
+            size_bytes(), threads, [this](std::size_t begin, std::size_t end) {
+                std::uninitialized_default_construct_n(entries_ + begin / sizeof(Entry),
+                                                       (end - begin) / sizeof(Entry));
+            });
+    }
+
+    std::optional<long long int> probe(Position::hash_type hash, int depth) const {
+        const Entry& entry = entries_[hash & mask_];
+        std::uint64_t data = entry.data.load(std::memory_order_relaxed);
+        std::uint64_t key = entry.key.load(std::memory_order_relaxed) ^ data;
+        if (key != hash || int(data & DEPTH_MASK) != depth) {
+            return std::nullopt;
+        }
+        return static_cast<long long int>(data >> DEPTH_BITS);
+    }
+    void store(Position::hash_type hash, int depth, long long int count) {
+        Entry& entry = entries_[hash & mask_];
+        std::uint64_t data = (std::uint64_t(count) << DEPTH_BITS) | std::uint64_t(depth);
+        entry.key.store(hash ^ data, std::memory_order_relaxed);
+        entry.data.store(data, std::memory_order_relaxed);
+    }
+    std::size_t size_bytes() const {
+        return (mask_ + 1) * sizeof(Entry);
+    }
+    memory::PageKind page_kind() const {
+        return buffer_.page_kind();
+    }
+
+   private:
+    // The low bits of the data hold the depth and the rest the count
+    constexpr static int DEPTH_BITS = 8;
+    constexpr static std::uint64_t DEPTH_MASK = (1 << DEPTH_BITS) - 1;
+
+    struct Entry {
+        std::atomic<std::uint64_t> key{0};
+        std::atomic<std::uint64_t> data{0};
+    };
+
+    memory::LargeBuffer buffer_;
+    Entry* entries_;
+    std::size_t mask_;
+};
+
+// How perft lists the moves of each node: the check-mask legal generator, the hand-written
+// pseudo-legal category functions filtered for legality, or the pseudo-legal generate<> templates
+// for evasions and non-evasions filtered the same way
+enum class MoveGen
+{
+    LEGAL,
+    PSEUDO_LEGAL,
+    TEMPLATE
+};
+
+inline MoveList perft_move_list(const Position& pos, MoveGen movegen) {
+    MoveList move_list;
+    switch (movegen) {
+        case MoveGen::LEGAL:
+            return pos.legal_move_list();
+        case MoveGen::PSEUDO_LEGAL:
+            for (Move move : pos.pseudo_legal_move_list()) {
+                if (pos.is_legal_generated_move(move)) {
+                    move_list.add(move);
+                }
+            }
+            break;
+        case MoveGen::TEMPLATE: {
+            MoveList pseudo_legal;
+            if (pos.in_check()) {
+                pos.generate<Position::GenType::EVASIONS>(pseudo_legal);
+            } else {
+                pos.generate<Position::GenType::NON_EVASIONS>(pseudo_legal);
+            }
+            for (Move move : pseudo_legal) {
+                if (pos.is_legal_generated_move(move)) {
+                    move_list.add(move);
+                }
+            }
+            break;
+        }
+    }
+    return move_list;
+}
+
+struct PerftStats {
+    long long int probes = 0;
+    long long int hits = 0;
+};
+
+inline long long int perft(Position& pos,
+                           int depth,
+                           bool bulk,
+                           MoveGen movegen,
+                           PerftTable* table,
+                           PerftStats& stats) {
+    if (bulk && depth == 1) {
+        return pos.legal_move_count();
+    }
+    if (table && depth > 1) {
+        ++stats.probes;
+        if (auto count = table->probe(pos.hash(), depth)) {
+            ++stats.hits;
+            return *count;
+        }
+    }
     long long int count = 0LL;
-    MoveList move_list = pos.legal_move_list();
+    MoveList move_list = perft_move_list(pos, movegen);
     if (depth == 1) {
         return move_list.size();
     }
     for (Move move : move_list) {
         pos.make_move(move);
-        count += perft(pos, depth - 1);
+        count += perft(pos, depth - 1, bulk, movegen, table, stats);
         pos.unmake_move();
     }
+    if (table) {
+        table->store(pos.hash(), depth, count);
+    }
     return count;
 }
 
+// A subtree to count: the moves leading to it from the root and the depth left below it
+struct PerftTask {
+    std::vector<Move> path;
+    int depth;
+};
+
+// Each worker pops tasks from the back of its own queue and, once that runs dry, steals from
+// the front of the others'
+class WorkStealingQueue {
+   public:
+    void push(PerftTask task) {
+        std::lock_guard<std::mutex> lock{mutex_};
+        tasks_.push_back(std::move(task));
+    }
+    std::optional<PerftTask> pop() {
+        std::lock_guard<std::mutex> lock{mutex_};
+        if (tasks_.empty()) {
+            return std::nullopt;
+        }
+        PerftTask task = std::move(tasks_.back());
+        tasks_.pop_back();
+        return task;
+    }
+    std::optional<PerftTask> steal() {
+        std::lock_guard<std::mutex> lock{mutex_};
+        if (tasks_.empty()) {
+            return std::nullopt;
+        }
+        PerftTask task = std::move(tasks_.front());
+        tasks_.pop_front();
+        return task;
+    }
+
+   private:
+    std::mutex mutex_;
+    std::deque<PerftTask> tasks_;
+};
+
+// Expands the tree breadth-first until there are enough subtrees to keep every thread busy,
+// always leaving at least one ply to each task
+std::vector<PerftTask> split_perft(const Position& root, int depth, int threads) {
+    std::vector<PerftTask> tasks{PerftTask{{}, depth}};
+    const std::size_t target_task_count = 16 * threads;
+    while (tasks.size() < target_task_count && tasks.front().depth > 1) {
+        std::vector<PerftTask> next_tasks;
+        for (const auto& task : tasks) {
+            Position pos = root;
+            for (Move move : task.path) {
+                pos.make_move(move);
+            }
+            for (Move move : pos.legal_move_list()) {
+                PerftTask child{task.path, task.depth - 1};
+                child.path.push_back(move);
+                next_tasks.push_back(std::move(child));
+            }
+        }
+        if (next_tasks.empty()) {
+            break;
+        }
+        tasks = std::move(next_tasks);
+    }
+    return tasks;
+}
+
+long long int parallel_perft(const Position& root,
+                            int depth,
+                            bool bulk,
+                            MoveGen movegen,
+                            int threads,
+                            PerftTable* table,
+                            PerftStats& stats) {
+    if (threads <= 1 || depth <= 1) {
+        Position pos = root;
+        return perft(pos, depth, bulk, movegen, table, stats);
+    }
+
+    std::vector<PerftTask> tasks = split_perft(root, depth, threads);
+    if (tasks.size() == 1 && tasks.front().depth == depth) {
+        // No legal moves at the root, or a single ply left
+        Position pos = root;
+        return perft(pos, depth, bulk, movegen, table, stats);
+    }
+
+    std::vector<WorkStealingQueue> queues(threads);
+    for (std::size_t i = 0; i < tasks.size(); ++i) {
+        queues[i % threads].push(std::move(tasks[i]));
+    }
+
+    std::atomic<long long int> total{0};
+    std::vector<PerftStats> worker_stats(threads);
+    auto worker = [&](int id) {
+        // Counted locally and written out once, as neighbouring workers' entries share cache lines
+        long long int count = 0LL;
+        PerftStats local_stats;
+        while (true) {
+            std::optional<PerftTask> task = queues[id].pop();
+            for (int i = 1; !task && i < threads; ++i) {
+                task = queues[(id + i) % threads].steal();
+            }
+            if (!task) {
+                break;
+            }
+            Position pos = root;
+            for (Move move : task->path) {
+                pos.make_move(move);
+            }
+            count += perft(pos, task->depth, bulk, movegen, table, local_stats);
+        }
+        total += count;
+        worker_stats[id] = local_stats;
+    };
+
+    std::vector<std::thread> workers;
+    for (int id = 0; id < threads; ++id) {
+        workers.emplace_back(worker, id);
+    }
+    for (auto& thread : workers) {
+        thread.join();
+    }
+    for (const auto& thread_stats : worker_stats) {
+        stats.probes += thread_stats.probes;
+        stats.hits += thread_stats.hits;
+    }
+    return total;
+}
+
 int main(int argc, char** argv) {
-    if (argc != 3) {
-        std::cout << "Usage: ./libchess_perft <file-path> <max-depth>\n";
+    if (argc < 3) {
+        std::cout << "Usage: ./libchess_perft <file-path> <max-depth> [--backend magic|pext] "
+                     "[--bulk] [--threads N] [--hash MB] [--movegen legal|pseudo|template]\n";
         return 1;
     }
     std::string epd_path = argv[1];
     int max_depth = std::atoi(argv[2]);
+    bool bulk = false;
+    MoveGen movegen = MoveGen::LEGAL;
+    int threads = 1;
+    std::size_t hash_mb = 0;
+    for (int i = 3; i < argc; ++i) {
+        std::string option = argv[i];
+        if (option == "--bulk") {
+            bulk = true;
+            continue;
+        }
+        if (option == "--threads" && i + 1 < argc) {
+            threads = std::atoi(argv[++i]);
+            if (threads < 1) {
+                std::cout << "Invalid thread count: " << argv[i] << "\n";
+                return 1;
+            }
+            continue;
+        }
+        if (option == "--hash" && i + 1 < argc) {
+            int megabytes = std::atoi(argv[++i]);
+            if (megabytes < 1) {
+                std::cout << "Invalid hash size: " << argv[i] << "\n";
+                return 1;
+            }
+            hash_mb = megabytes;
+            continue;
+        }
+        if (option == "--movegen" && i + 1 < argc) {
+            std::string name = argv[++i];
+            if (name == "legal") {
+                movegen = MoveGen::LEGAL;
+            } else if (name == "pseudo") {
+                movegen = MoveGen::PSEUDO_LEGAL;
+            } else if (name == "template") {
+                movegen = MoveGen::TEMPLATE;
+            } else {
+                std::cout << "Unknown move generator: " << name << "\n";
+                return 1;
+            }
+            continue;
+        }
+        std::string backend = i + 1 < argc ? argv[++i] : "";
+        if (option != "--backend" || (backend != "magic" && backend != "pext")) {
+            std::cout << "Unknown option: " << option << " " << backend << "\n";
+            return 1;
+        }
+        auto slider_backend =
+            backend == "pext" ? lookups::SliderBackend::PEXT : lookups::SliderBackend::MAGIC;
+        if (!lookups::set_slider_backend(slider_backend)) {
+            std::cout << "Slider backend not supported on this CPU: " << backend << "\n";
+            return 1;
+        }
+    }
+    std::cout << "slider backend: " << lookups::slider_backend_name() << "\n";
+    if (bulk) {
+        std::cout << "bulk counting leaf moves\n";
+    }
+    std::cout << "threads: " << threads << "\n";
+    std::unique_ptr<PerftTable> table;
+    if (hash_mb) {
+        table = std::make_unique<PerftTable>(hash_mb, threads);
+        std::cout << "hash: " << (table->size_bytes() >> 20) << " MB, "
+                  << memory::to_str(table->page_kind()) << " pages\n";
+    }
     std::ifstream file{epd_path};
     std::string line;
     int line_nr = 0;
@@ -59,7 +381,9 @@ int main(int argc, char** argv) {
             }
             auto expected_result = std::strtoll(result_token.begin(), &endptr, 10);
             auto start_ts = std::chrono::system_clock::now();
-            auto actual_result = perft(pos, depth);
+            PerftStats stats;
+            auto actual_result =
+                parallel_perft(pos, depth, bulk, movegen, threads, table.get(), stats);
             auto end_ts = std::chrono::system_clock::now();
             std::chrono::duration<double> diff_ts = end_ts - start_ts;
             if (actual_result != expected_result) {
@@ -71,7 +395,13 @@ int main(int argc, char** argv) {
                 double nps = time_s > 0.0 ? actual_result / time_s : actual_result;
                 std::cout << "line: " << line_nr << ", depth: " << depth
                           << ", nps: " << std::setprecision(4) << nps
-                          << ", count: " << actual_result << "\n";
+                          << ", count: " << actual_result;
+                if (table) {
+                    double hit_rate = stats.probes ? 100.0 * stats.hits / stats.probes : 0.0;
+                    std::cout << ", hash hits: " << hit_rate << "%"
+                              << ", hash memory: " << (table->size_bytes() >> 20) << " MB";
+                }
+                std::cout << "\n";
             }
         }
     }
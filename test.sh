@@ -5,3 +5,7 @@ cmake ..
 make
 make test
 ./perft/perft ./perft/perfts.epd 6
+./perft/perft ./perft/perfts.epd 6 --backend magic
+./perft/perft ./perft/perfts.epd 6 --movegen template
+./perft/perft ./perft/perfts.epd 6 --bulk --threads "$(nproc)"
+./perft/perft ./perft/perfts.epd 6 --bulk --threads "$(nproc)" --hash 256
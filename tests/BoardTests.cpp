@@ -0,0 +1,125 @@
+#include <catch2/catch_all.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "../Board.h"
+#include "../Position.h"
+
+using namespace libchess;
+using namespace constants;
+
+namespace {
+
+void require_same_state(const Board& board, const Position& pos) {
+    for (PieceType pt : PIECE_TYPES) {
+        REQUIRE(board.piece_type_bb(pt) == pos.piece_type_bb(pt));
+    }
+    for (Color c : COLORS) {
+        REQUIRE(board.color_bb(c) == pos.color_bb(c));
+    }
+    REQUIRE(board.side_to_move() == pos.side_to_move());
+    REQUIRE(board.castling_rights() == pos.castling_rights());
+    REQUIRE(board.enpassant_square() == pos.enpassant_square());
+    REQUIRE(board.halfmoves() == pos.halfmoves());
+    REQUIRE(board.fullmoves() == pos.fullmoves());
+    REQUIRE(board.hash() == pos.hash());
+    REQUIRE(board.pawn_hash() == pos.pawn_hash());
+    REQUIRE(board.checkers() == pos.checkers_to(pos.side_to_move()));
+}
+
+// Copy-makes every legal move on the board alongside make_move on the position
+void check_copy_make(Position& pos, const Board& board, int depth) {
+    require_same_state(board, pos);
+    MoveList board_moves = board.legal_move_list();
+    MoveList pos_moves = pos.legal_move_list();
+    REQUIRE(board_moves.size() == pos_moves.size());
+    REQUIRE(board.legal_move_count() == pos.legal_move_count());
+    REQUIRE(board.has_legal_move() == pos.has_legal_move());
+    MoveList captures = board.legal_capture_list();
+    MoveList quiets = board.legal_quiet_list();
+    REQUIRE(captures.size() + quiets.size() == board_moves.size());
+    for (Move move : captures) {
+        REQUIRE(pos.is_capture_move(move));
+    }
+    for (Move move : quiets) {
+        REQUIRE(!pos.is_capture_move(move));
+    }
+    for (Move move : pos.pseudo_legal_move_list()) {
+        REQUIRE(board.is_legal_move(move) == pos.is_legal_move(move));
+        REQUIRE(board.gives_check(move) == pos.gives_check(move));
+        REQUIRE(board.see_for(move, SEE_PIECE_VALUES) == pos.see_for(move, SEE_PIECE_VALUES));
+        REQUIRE(board.see_ge(move, 0) == pos.see_ge(move, 0));
+        REQUIRE(board.see_ge(move, 200) == pos.see_ge(move, 200));
+    }
+    for (Square sq = A1; sq <= H8; ++sq) {
+        REQUIRE(board.smallest_capture_move_to(sq) == pos.smallest_capture_move_to(sq));
+        REQUIRE(board.see_to(sq, SEE_PIECE_VALUES) == pos.see_to(sq, SEE_PIECE_VALUES));
+    }
+    if (depth == 0) {
+        return;
+    }
+    for (Move move : pos_moves) {
+        REQUIRE(board_moves.contains(move));
+        REQUIRE(board.move_type_of(move) == pos.move_type_of(move));
+        REQUIRE(board.is_capture_move(move) == pos.is_capture_move(move));
+        Board child = board;
+        child.make_move(move);
+        pos.make_move(move);
+        check_copy_make(pos, child, depth - 1);
+        pos.unmake_move();
+    }
+}
+
+long long board_perft(const Board& board, int depth) {
+    MoveList move_list = board.legal_move_list();
+    if (depth == 1) {
+        return move_list.size();
+    }
+    long long nodes = 0;
+    for (Move move : move_list) {
+        Board child = board;
+        child.make_move(move);
+        nodes += board_perft(child, depth - 1);
+    }
+    return nodes;
+}
+
+}  // namespace
+
+TEST_CASE("Board Copy-Make Test", "[Board]") {
+    std::vector<std::string> fens = {
+        STARTPOS_FEN,
+        "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+        "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+        "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+        "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+        "8/8/8/K2pP2r/8/8/8/7k w - d6 0 2",
+    };
+    for (const auto& fen : fens) {
+        Position pos{fen};
+        check_copy_make(pos, pos.board(), 3);
+    }
+}
+
+TEST_CASE("Board Perft Test", "[Board]") {
+    Position pos{"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1"};
+    REQUIRE(board_perft(pos.board(), 3) == 97862);
+    pos = Position{"8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1"};
+    REQUIRE(board_perft(pos.board(), 4) == 43238);
+}
+
+TEST_CASE("Board Null Move and Snapshot Test", "[Board]") {
+    Position pos{"rnbqkbnr/ppp1pppp/8/8/3pP3/5N2/PPPP1PPP/RNBQKB1R b KQkq e3 0 3"};
+    Board board = pos.board();
+    Board copy;
+    std::memcpy(static_cast<void*>(&copy), &board, sizeof(Board));
+    REQUIRE(copy.hash() == board.hash());
+
+    board.make_null_move();
+    pos.make_null_move();
+    require_same_state(board, pos);
+    REQUIRE(copy.enpassant_square() == E3);
+}
@@ -0,0 +1,76 @@
+#include <catch2/catch_all.hpp>
+
+#include <atomic>
+#include <thread>
+
+#include "../Lookups.h"
+
+using namespace libchess;
+using namespace constants;
+
+namespace {
+
+void check_slider_attacks_against_classical() {
+    std::uint64_t seed = 0x9E3779B97F4A7C15;
+    for (int i = 0; i < 200; ++i) {
+        seed ^= seed >> 12;
+        seed ^= seed << 25;
+        seed ^= seed >> 27;
+        Bitboard occupancy{(seed * std::uint64_t(2685821657736338717)) & seed};
+        for (Square sq = A1; sq <= H8; ++sq) {
+            REQUIRE(lookups::magic_bishop_attacks(sq, occupancy) ==
+                    lookups::classical_bishop_attacks(sq, occupancy));
+            REQUIRE(lookups::magic_rook_attacks(sq, occupancy) ==
+                    lookups::classical_rook_attacks(sq, occupancy));
+            REQUIRE(lookups::magic_queen_attacks(sq, occupancy) ==
+                    lookups::classical_queen_attacks(sq, occupancy));
+        }
+    }
+}
+
+}  // namespace
+
+TEST_CASE("Magic Slider Attacks Test", "[Lookups]") {
+    auto original_backend = lookups::slider_backend();
+    REQUIRE(lookups::set_slider_backend(lookups::SliderBackend::MAGIC));
+    check_slider_attacks_against_classical();
+    lookups::set_slider_backend(original_backend);
+}
+
+TEST_CASE("PEXT Slider Attacks Test", "[Lookups]") {
+    if (!cpu::supports_pext()) {
+        REQUIRE(!lookups::set_slider_backend(lookups::SliderBackend::PEXT));
+        return;
+    }
+    auto original_backend = lookups::slider_backend();
+    REQUIRE(lookups::set_slider_backend(lookups::SliderBackend::PEXT));
+    REQUIRE(lookups::slider_backend() == lookups::SliderBackend::PEXT);
+    check_slider_attacks_against_classical();
+    lookups::set_slider_backend(original_backend);
+}
+
+TEST_CASE("Slider Backend Switch Test", "[Lookups]") {
+    // Lookups racing with backend switches still see one complete table or the other
+    auto original_backend = lookups::slider_backend();
+    std::atomic<bool> done{false};
+    std::atomic<int> mismatches{0};
+    std::thread reader{[&] {
+        Bitboard occupancy{std::uint64_t(0x0000FF00FF000000)};
+        while (!done.load()) {
+            for (Square sq = A1; sq <= H8; ++sq) {
+                if (lookups::queen_attacks(sq, occupancy) !=
+                    lookups::classical_queen_attacks(sq, occupancy)) {
+                    ++mismatches;
+                }
+            }
+        }
+    }};
+    for (int i = 0; i < 1000; ++i) {
+        lookups::set_slider_backend(i % 2 ? lookups::SliderBackend::MAGIC
+                                          : lookups::SliderBackend::PEXT);
+    }
+    done = true;
+    reader.join();
+    lookups::set_slider_backend(original_backend);
+    REQUIRE(mismatches == 0);
+}
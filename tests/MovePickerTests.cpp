@@ -0,0 +1,88 @@
+#include <catch2/catch_all.hpp>
+
+#include <algorithm>
+#include <vector>
+
+#include "../MovePicker.h"
+
+using namespace libchess;
+using namespace constants;
+
+namespace {
+
+std::vector<Move> picked_moves(MovePicker& picker) {
+    std::vector<Move> moves;
+    while (auto move = picker.next_move()) {
+        moves.push_back(*move);
+    }
+    return moves;
+}
+
+// Every legal move is picked exactly once, whatever the TT move and killers
+void check_picks_legal_moves(const Position& pos, std::optional<Move> tt_move,
+                             std::array<Move, 2> killers) {
+    MovePicker picker{pos, tt_move, killers};
+    std::vector<Move> moves = picked_moves(picker);
+    MoveList legal_moves = pos.legal_move_list();
+    REQUIRE(int(moves.size()) == legal_moves.size());
+    for (Move move : legal_moves) {
+        REQUIRE(std::count(moves.begin(), moves.end(), move) == 1);
+    }
+    REQUIRE(picker.stage() == MovePicker::Stage::DONE);
+}
+
+}  // namespace
+
+TEST_CASE("MovePicker Legal Moves Test", "[MovePicker]") {
+    for (const std::string fen : {
+             "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+             "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+             "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+             "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+             "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+             "4k3/8/8/8/1b6/8/8/R3K2R w KQ - 0 1",
+         }) {
+        Position pos{fen};
+        check_picks_legal_moves(pos, std::nullopt, {});
+        MoveList legal_moves = pos.legal_move_list();
+        Move first = *legal_moves.begin();
+        Move last = *(legal_moves.end() - 1);
+        check_picks_legal_moves(pos, first, {last, first});
+        // Illegal TT moves and killers are never picked
+        check_picks_legal_moves(pos, Move{H8, H1}, {Move{A1, H8}, Move{}});
+    }
+}
+
+TEST_CASE("MovePicker Stage Order Test", "[MovePicker]") {
+    Position pos{"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1"};
+    Move tt_move{E1, G1};
+    Move killer{A2, A3};
+    MovePicker::ButterflyHistory history{};
+    history[D5][D6] = 100;
+    MovePicker picker{pos, tt_move, {killer, Move{}}, &history};
+    std::vector<Move> moves = picked_moves(picker);
+
+    REQUIRE(moves.front() == tt_move);
+    // Captures of the most valuable victim come first, losing ones only after the quiets
+    REQUIRE(moves[1] == Move{E2, A6});
+    auto killer_it = std::find(moves.begin(), moves.end(), killer);
+    auto losing_capture_it = std::find(moves.begin(), moves.end(), Move{F3, F6});
+    auto winning_capture_it = std::find(moves.begin(), moves.end(), Move{G2, H3});
+    auto best_quiet_it = std::find(moves.begin(), moves.end(), Move{D5, D6});
+    REQUIRE(winning_capture_it < killer_it);
+    REQUIRE(killer_it + 1 == best_quiet_it);
+    REQUIRE(best_quiet_it < losing_capture_it);
+}
+
+TEST_CASE("MovePicker Evasions Test", "[MovePicker]") {
+    Position pos{"4k3/8/8/8/1b6/8/3P4/R3K2R w KQ - 0 1"};
+    pos.make_move(Move{D2, D3});
+    pos.make_move(Move{B4, C3});
+    REQUIRE(pos.in_check());
+    check_picks_legal_moves(pos, std::nullopt, {});
+
+    MovePicker picker{pos, Move{E1, E2}};
+    std::vector<Move> moves = picked_moves(picker);
+    REQUIRE(moves.front() == Move{E1, E2});
+    REQUIRE(picker.stage() == MovePicker::Stage::DONE);
+}
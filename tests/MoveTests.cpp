@@ -61,3 +61,32 @@ TEST_CASE("Default Initialization test", "[Move]") {
     REQUIRE(moves[0] == Move(0));
     REQUIRE(moves[1] == Move(0));
 }
+
+TEST_CASE("MoveList Test", "[MoveList]") {
+    MoveList move_list;
+    REQUIRE(move_list.empty());
+
+    move_list.add(Move{E2, E4, Move::Type::DOUBLE_PUSH});
+    move_list.add(Move{G1, F3});
+    move_list.add(Move{D2, D3});
+    REQUIRE(move_list.size() == 3);
+    REQUIRE(move_list.contains(Move{G1, F3}));
+    REQUIRE(!move_list.contains(Move{B1, C3}));
+
+    move_list.sort([](Move move) { return move.to_square().value(); });
+    REQUIRE(move_list.values() == std::vector<Move>{{E2, E4}, {G1, F3}, {D2, D3}});
+    std::vector<Move> values = move_list.values();
+    REQUIRE(values.size() == 3);
+    REQUIRE(move_list.values().data() == &*move_list.begin());
+    REQUIRE(move_list.values()[1] == Move{G1, F3});
+
+    MoveList copy = move_list;
+    move_list.pop_back();
+    REQUIRE(move_list.size() == 2);
+    REQUIRE(copy.size() == 3);
+
+    copy.add(move_list);
+    REQUIRE(copy.size() == 5);
+    copy.clear();
+    REQUIRE(copy.empty());
+}
@@ -0,0 +1,211 @@
+#include <catch2/catch_all.hpp>
+
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../NNUE.h"
+#include "../Position.h"
+
+using namespace libchess;
+using namespace constants;
+
+namespace {
+
+// Writes a network of random weights, small enough that the hidden layers are neither all zero
+// nor all clipped
+std::string write_random_network() {
+    std::vector<char> data(nnue::layout::FILE_SIZE, 0);
+    nnue::layout::Header header{};
+    header.magic = nnue::layout::MAGIC;
+    header.version = nnue::layout::VERSION;
+    header.input_dimensions = nnue::INPUT_DIMENSIONS;
+    header.half_dimensions = nnue::HALF_DIMENSIONS;
+    header.l2_inputs = nnue::L2_INPUTS;
+    header.l3_inputs = nnue::L3_INPUTS;
+    std::memcpy(data.data(), &header, sizeof(header));
+
+    std::mt19937 rng{12345};
+    auto fill = [&](std::size_t offset, std::size_t count, auto type_tag, int low, int high) {
+        using T = decltype(type_tag);
+        std::uniform_int_distribution<int> dist{low, high};
+        for (std::size_t i = 0; i < count; ++i) {
+            T value = T(dist(rng));
+            std::memcpy(data.data() + offset + i * sizeof(T), &value, sizeof(T));
+        }
+    };
+    fill(nnue::layout::FT_BIASES, nnue::HALF_DIMENSIONS, std::int16_t{}, -20, 60);
+    fill(nnue::layout::FT_WEIGHTS,
+         std::size_t(nnue::INPUT_DIMENSIONS) * nnue::HALF_DIMENSIONS,
+         std::int16_t{},
+         -16,
+         16);
+    fill(nnue::layout::L1_BIASES, nnue::L2_INPUTS, std::int32_t{}, -500, 500);
+    fill(nnue::layout::L1_WEIGHTS, nnue::L2_INPUTS * nnue::L1_INPUTS, std::int8_t{}, -128, 127);
+    fill(nnue::layout::L2_BIASES, nnue::L3_INPUTS, std::int32_t{}, -500, 500);
+    fill(nnue::layout::L2_WEIGHTS, nnue::L3_INPUTS * nnue::L2_INPUTS, std::int8_t{}, -128, 127);
+    fill(nnue::layout::OUTPUT_BIAS, 1, std::int32_t{}, -100, 100);
+    fill(nnue::layout::OUTPUT_WEIGHTS, nnue::L3_INPUTS, std::int8_t{}, -128, 127);
+
+    std::string path = (std::filesystem::temp_directory_path() / "libchess_test.nnue").string();
+    std::ofstream file{path, std::ios::binary};
+    file.write(data.data(), std::streamsize(data.size()));
+    return path;
+}
+
+nnue::Network& test_network() {
+    static std::string path = write_random_network();
+    static nnue::Network network = *nnue::Network::load(path);
+    return network;
+}
+
+void require_same_accumulator(const nnue::Accumulator& lhs, const nnue::Accumulator& rhs) {
+    REQUIRE(std::memcmp(lhs.values, rhs.values, sizeof(lhs.values)) == 0);
+}
+
+void require_refreshed_accumulator(const Position& pos) {
+    Position refreshed = pos;
+    refreshed.set_network(pos.network());
+    require_same_accumulator(pos.accumulator(), refreshed.accumulator());
+}
+
+// With every_node unset the accumulators are only needed at the leaves, so each is brought up to
+// date across several plies at once
+void check_accumulator(Position& pos, int depth, bool every_node = true) {
+    if (every_node || depth == 0) {
+        require_refreshed_accumulator(pos);
+    }
+    if (depth == 0) {
+        return;
+    }
+    for (Move move : pos.legal_move_list()) {
+        pos.make_move(move);
+        check_accumulator(pos, depth - 1, every_node);
+        pos.unmake_move();
+    }
+}
+
+}  // namespace
+
+TEST_CASE("NNUE Load Test", "[NNUE]") {
+    REQUIRE(!nnue::Network::load("/nonexistent/libchess.nnue"));
+
+    std::string path = (std::filesystem::temp_directory_path() / "libchess_short.nnue").string();
+    {
+        std::ofstream file{path, std::ios::binary};
+        file << "LCNN";
+    }
+    REQUIRE(!nnue::Network::load(path));
+    std::remove(path.c_str());
+
+    REQUIRE(nnue::kernels::is_supported(test_network().kernel()));
+
+    // The fallback for systems without mmap reads the same bytes
+    std::string network_path =
+        (std::filesystem::temp_directory_path() / "libchess_test.nnue").string();
+    auto mapped = MappedFile::open(network_path);
+    auto read = MappedFile::read(network_path);
+    REQUIRE(mapped);
+    REQUIRE(read);
+    REQUIRE(!read->mapped());
+    REQUIRE(read->size() == mapped->size());
+    REQUIRE(std::uintptr_t(read->data()) % 64 == 0);
+    REQUIRE(std::memcmp(read->data(), mapped->data(), read->size()) == 0);
+    REQUIRE(!MappedFile::read("/nonexistent/libchess.nnue"));
+}
+
+TEST_CASE("NNUE Incremental Accumulator Test", "[NNUE]") {
+    // castling, enpassant and promotions from both sides
+    for (const std::string fen : {
+             "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+             "rnbqkbnr/ppp1p1pp/8/3pPp2/8/8/PPPP1PPP/RNBQKBNR w KQkq f6 0 3",
+             "n1n5/PPPk4/8/8/8/8/4Kppp/5N1N b - - 0 1",
+         }) {
+        Position pos{fen};
+        pos.set_network(&test_network());
+        nnue::Accumulator start = pos.accumulator();
+        check_accumulator(pos, 3);
+        check_accumulator(pos, 3, false);
+        require_same_accumulator(pos.accumulator(), start);
+
+        pos.make_null_move();
+        check_accumulator(pos, 2, false);
+        pos.unmake_move();
+
+        Position::UndoInfo undo;
+        for (Move move : pos.legal_move_list()) {
+            pos.make_move(move, undo);
+            Position refreshed = pos;
+            refreshed.set_network(&test_network());
+            require_same_accumulator(pos.accumulator(), refreshed.accumulator());
+            pos.unmake_move(move, undo);
+        }
+        require_same_accumulator(pos.accumulator(), start);
+
+        // Unmaking past the ply the network was set at rebuilds the accumulator
+        Move move = *pos.legal_move_list().begin();
+        pos.make_move(move);
+        pos.set_network(&test_network());
+        pos.unmake_move();
+        require_same_accumulator(pos.accumulator(), start);
+        pos.make_move(move);
+        require_refreshed_accumulator(pos);
+        pos.unmake_move();
+    }
+}
+
+TEST_CASE("NNUE Accumulator Stack Growth Test", "[NNUE]") {
+    // Lines deeper than the stack set_network() allocates grow it
+    Position pos{STARTPOS_FEN};
+    pos.set_network(&test_network());
+    nnue::Accumulator start = pos.accumulator();
+    int plies = 0;
+    while (plies < 2 * Position::ACCUMULATOR_PLIES) {
+        for (Move move : {Move{G1, F3}, Move{G8, F6}, Move{F3, G1}, Move{F6, G8}}) {
+            pos.make_move(move);
+            ++plies;
+        }
+    }
+    require_refreshed_accumulator(pos);
+    Position copy = pos;
+    require_refreshed_accumulator(copy);
+    for (int i = 0; i < plies; ++i) {
+        pos.unmake_move();
+    }
+    require_same_accumulator(pos.accumulator(), start);
+}
+
+TEST_CASE("NNUE Kernel Test", "[NNUE]") {
+    nnue::Network& network = test_network();
+    nnue::Kernel best_kernel = network.kernel();
+    std::vector<int> scalar_evals;
+    std::vector<nnue::Accumulator> scalar_accumulators;
+    bool distinct_evals = false;
+    for (nnue::Kernel kernel : {nnue::Kernel::SCALAR, nnue::Kernel::SSE41, nnue::Kernel::AVX2}) {
+        if (!network.set_kernel(kernel)) {
+            continue;
+        }
+        Position pos{"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1"};
+        pos.set_network(&network);
+        std::size_t i = 0;
+        for (Move move : pos.legal_move_list()) {
+            pos.make_move(move);
+            if (kernel == nnue::Kernel::SCALAR) {
+                scalar_evals.push_back(pos.nnue_evaluate());
+                scalar_accumulators.push_back(pos.accumulator());
+                distinct_evals |= scalar_evals.back() != scalar_evals.front();
+            } else {
+                REQUIRE(pos.nnue_evaluate() == scalar_evals[i]);
+                require_same_accumulator(pos.accumulator(), scalar_accumulators[i]);
+            }
+            pos.unmake_move();
+            ++i;
+        }
+    }
+    network.set_kernel(best_kernel);
+    REQUIRE(distinct_evals);
+}
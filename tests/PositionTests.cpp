@@ -1,5 +1,9 @@
 #include <catch2/catch_all.hpp>
 
+#include <algorithm>
+#include <random>
+#include <vector>
+
 #include "../Position.h"
 
 using namespace libchess;
@@ -64,6 +68,355 @@ TEST_CASE("Hash Test", "[Position]") {
     }
 }
 
+namespace {
+
+void check_mailbox(const Position& pos) {
+    for (Square sq : SQUARES) {
+        auto piece = pos.piece_on(sq);
+        if (!piece) {
+            REQUIRE(!(pos.occupancy_bb() & Bitboard{sq}));
+            continue;
+        }
+        REQUIRE(pos.piece_type_bb(piece->type(), piece->color()) & Bitboard{sq});
+        REQUIRE(pos.piece_type_on(sq) == piece->type());
+        REQUIRE(pos.color_of(sq) == piece->color());
+    }
+}
+
+void check_check_info(const Position& pos) {
+    for (Color c : COLORS) {
+        Bitboard checkers = pos.attackers_to(pos.king_square(c), !c);
+        REQUIRE(pos.checkers_to(c) == checkers);
+
+        Bitboard king_blockers;
+        Bitboard pinned;
+        for (Square sq : SQUARES) {
+            Bitboard sq_bb{sq};
+            auto piece = pos.piece_on(sq);
+            if (!piece || piece->type() == KING) {
+                continue;
+            }
+            Bitboard occupancy = pos.occupancy_bb() ^ sq_bb;
+            if (pos.attackers_to(pos.king_square(c), occupancy, !c) != checkers) {
+                king_blockers |= sq_bb;
+                if (piece->color() == c) {
+                    pinned |= sq_bb;
+                }
+            }
+        }
+        REQUIRE(pos.king_blockers(c) == king_blockers);
+        REQUIRE(pos.pinned_pieces_of(c) == pinned);
+    }
+
+    Color stm = pos.side_to_move();
+    Square king_sq = pos.king_square(!stm);
+    for (PieceType pt : {PAWN, KNIGHT, BISHOP, ROOK, QUEEN}) {
+        Bitboard check_squares;
+        for (Square sq : SQUARES) {
+            Bitboard attacks = pt == PAWN ? lookups::pawn_attacks(sq, stm)
+                                          : lookups::non_pawn_piece_type_attacks(
+                                                pt, sq, pos.occupancy_bb());
+            if (attacks & Bitboard{king_sq}) {
+                check_squares |= Bitboard{sq};
+            }
+        }
+        REQUIRE(pos.check_squares(pt) == check_squares);
+    }
+}
+
+// Arbitrary values that differ by piece, square and phase
+PSQT make_test_psqt() {
+    PSQT psqt{};
+    for (PieceType pt : PIECE_TYPES) {
+        for (Square sq : SQUARES) {
+            psqt.mg[pt.value()][sq.value()] = (pt.value() + 1) * 100 + sq.value();
+            psqt.eg[pt.value()][sq.value()] = (pt.value() + 1) * 90 - sq.value() * 3;
+        }
+    }
+    return psqt;
+}
+
+void check_material(const Position& pos) {
+    REQUIRE(pos.material_key() == pos.calculate_material_key());
+    for (Color c : COLORS) {
+        int mg = 0;
+        int eg = 0;
+        for (PieceType pt : PIECE_TYPES) {
+            Bitboard bb = pos.piece_type_bb(pt, c);
+            REQUIRE(pos.piece_count(pt, c) == bb.popcount());
+            while (pos.psqt() && bb) {
+                mg += pos.psqt()->mg_value(bb.forward_bitscan(), pt, c);
+                eg += pos.psqt()->eg_value(bb.forward_bitscan(), pt, c);
+                bb.forward_popbit();
+            }
+        }
+        REQUIRE(pos.psqt_mg(c) == mg);
+        REQUIRE(pos.psqt_eg(c) == eg);
+    }
+}
+
+void check_incremental_state(Position& pos, int depth) {
+    REQUIRE(pos.hash() == pos.calculate_hash());
+    check_material(pos);
+    check_mailbox(pos);
+    check_check_info(pos);
+    if (depth == 0) {
+        return;
+    }
+    for (Move move : pos.legal_move_list()) {
+        Position::hash_type hash_after = pos.hash_after(move);
+        Position::hash_type pawn_hash_after = pos.pawn_hash_after(move);
+        pos.make_move(move);
+        REQUIRE(pos.hash() == hash_after);
+        REQUIRE(pos.pawn_hash() == pawn_hash_after);
+        check_incremental_state(pos, depth - 1);
+        pos.unmake_move();
+    }
+}
+
+// Each move made in place with a caller-owned UndoInfo leaves the same position as make_move
+void check_undo_info(Position& pos, Position::UndoInfo* undo_stack, int depth) {
+    if (depth == 0) {
+        return;
+    }
+    for (Move move : pos.legal_move_list()) {
+        Position expected = pos;
+        expected.make_move(move);
+        pos.make_move(move, *undo_stack);
+        REQUIRE(pos.fen() == expected.fen());
+        REQUIRE(pos.hash() == expected.hash());
+        REQUIRE(pos.pawn_hash() == expected.pawn_hash());
+        REQUIRE(pos.in_check() == expected.in_check());
+        check_mailbox(pos);
+        check_check_info(pos);
+        check_material(pos);
+        check_undo_info(pos, undo_stack + 1, depth - 1);
+        pos.unmake_move(move, *undo_stack);
+    }
+}
+
+void check_legal_move_count(Position& pos, int depth) {
+    MoveList move_list = pos.legal_move_list();
+    REQUIRE(pos.legal_move_count() == move_list.size());
+    REQUIRE(pos.has_legal_move() == !move_list.empty());
+    if (depth == 0) {
+        return;
+    }
+    for (Move move : move_list) {
+        pos.make_move(move);
+        check_legal_move_count(pos, depth - 1);
+        pos.unmake_move();
+    }
+}
+
+// Both lists hold the same moves, with the same move types
+void require_same_moves(const MoveList& move_list, const MoveList& expected) {
+    REQUIRE(move_list.size() == expected.size());
+    for (Move move : move_list) {
+        auto found = std::find(expected.begin(), expected.end(), move);
+        REQUIRE(found != expected.end());
+        REQUIRE(found->type() == move.type());
+    }
+}
+
+void check_generate(Position& pos, int depth) {
+    MoveList legal;
+    pos.generate<Position::GenType::LEGAL>(legal);
+    require_same_moves(legal, pos.legal_move_list());
+    for (Move move : legal) {
+        bool gives_check = pos.gives_check(move);
+        pos.make_move(move);
+        REQUIRE(gives_check == pos.in_check());
+        pos.unmake_move();
+    }
+
+    if (pos.in_check()) {
+        MoveList evasions;
+        pos.generate<Position::GenType::EVASIONS>(evasions);
+        require_same_moves(evasions, pos.check_evasion_move_list());
+    } else {
+        MoveList captures, expected_captures;
+        pos.generate<Position::GenType::CAPTURES>(captures);
+        pos.generate_capture_moves(expected_captures, pos.side_to_move());
+        require_same_moves(captures, expected_captures);
+
+        MoveList quiets, expected_quiets;
+        pos.generate<Position::GenType::QUIETS>(quiets);
+        pos.generate_quiet_moves(expected_quiets, pos.side_to_move());
+        require_same_moves(quiets, expected_quiets);
+
+        MoveList non_evasions;
+        pos.generate<Position::GenType::NON_EVASIONS>(non_evasions);
+        require_same_moves(non_evasions, pos.pseudo_legal_move_list());
+
+        // Compared on the legal moves only, as a king stepping next to the other king would
+        // count as giving check
+        MoveList quiet_checks, legal_quiet_checks, expected_quiet_checks;
+        pos.generate<Position::GenType::QUIET_CHECKS>(quiet_checks);
+        for (Move move : quiet_checks) {
+            if (pos.is_legal_generated_move(move)) {
+                legal_quiet_checks.add(move);
+            }
+        }
+        for (Move move : expected_quiets) {
+            if (!pos.is_legal_generated_move(move)) {
+                continue;
+            }
+            pos.make_move(move);
+            if (pos.in_check()) {
+                expected_quiet_checks.add(move);
+            }
+            pos.unmake_move();
+        }
+        require_same_moves(legal_quiet_checks, expected_quiet_checks);
+    }
+
+    if (depth == 0) {
+        return;
+    }
+    for (Move move : legal) {
+        pos.make_move(move);
+        check_generate(pos, depth - 1);
+        pos.unmake_move();
+    }
+}
+
+// Every from/to pair of the side to move, with each promotion for pawns, is accepted by
+// is_legal_move() exactly when full generation produces it
+void check_is_legal_move(Position& pos, int depth) {
+    MoveList legal = pos.legal_move_list();
+    std::vector<Move> mismatches;
+    Bitboard pieces = pos.color_bb(pos.side_to_move());
+    while (pieces) {
+        Square from_sq = pieces.forward_bitscan();
+        pieces.forward_popbit();
+        for (Square to_sq : SQUARES) {
+            std::vector<Move> candidates{Move{from_sq, to_sq}};
+            if (pos.piece_type_on(from_sq) == PAWN) {
+                for (PieceType pt : {KNIGHT, BISHOP, ROOK, QUEEN, KING}) {
+                    candidates.push_back(Move{from_sq, to_sq, pt});
+                }
+            }
+            for (Move move : candidates) {
+                if (pos.is_legal_move(move) != legal.contains(move)) {
+                    mismatches.push_back(move);
+                }
+            }
+        }
+    }
+    REQUIRE(mismatches.empty());
+    for (Move move : legal) {
+        REQUIRE(pos.is_legal_move(move));
+    }
+
+    if (depth == 0) {
+        return;
+    }
+    for (Move move : legal) {
+        pos.make_move(move);
+        check_is_legal_move(pos, depth - 1);
+        pos.unmake_move();
+    }
+}
+
+}  // namespace
+
+TEST_CASE("Incremental Hash, Mailbox and Check Info Test", "[Position]") {
+    // castling, enpassant and promotions from both sides
+    for (const std::string fen : {
+             "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+             "rnbqkbnr/ppp1p1pp/8/3pPp2/8/8/PPPP1PPP/RNBQKBNR w KQkq f6 0 3",
+             "n1n5/PPPk4/8/8/8/8/4Kppp/5N1N b - - 0 1",
+         }) {
+        Position pos{fen};
+        PSQT psqt = make_test_psqt();
+        pos.set_psqt(&psqt);
+        Position::hash_type start_hash = pos.hash();
+        check_incremental_state(pos, 2);
+        REQUIRE(pos.hash() == start_hash);
+
+        pos.make_null_move();
+        REQUIRE(pos.hash() == pos.calculate_hash());
+        pos.unmake_move();
+        REQUIRE(pos.hash() == start_hash);
+    }
+}
+
+TEST_CASE("UndoInfo Make/Unmake Test", "[Position]") {
+    for (const std::string fen : {
+             "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+             "rnbqkbnr/ppp1p1pp/8/3pPp2/8/8/PPPP1PPP/RNBQKBNR w KQkq f6 0 3",
+             "n1n5/PPPk4/8/8/8/8/4Kppp/5N1N b - - 0 1",
+         }) {
+        Position pos{fen};
+        Position::UndoInfo undo_stack[3];
+        check_undo_info(pos, undo_stack, 3);
+        REQUIRE(pos.fen() == fen);
+        REQUIRE(pos.hash() == pos.calculate_hash());
+        check_check_info(pos);
+    }
+}
+
+TEST_CASE("UndoInfo Repetition Test", "[Position]") {
+    // Moves made with an UndoInfo are part of the history that repetition checks scan
+    Position pos{STARTPOS_FEN};
+    Position expected{STARTPOS_FEN};
+    Position::UndoInfo undo_stack[8];
+    std::vector<Move> moves;
+    for (int i = 0; i < 2; ++i) {
+        for (Move move : {Move{G1, F3}, Move{G8, F6}, Move{F3, G1}, Move{F6, G8}}) {
+            pos.make_move(move, undo_stack[moves.size()]);
+            expected.make_move(move);
+            moves.push_back(move);
+            REQUIRE(pos.is_repeat(1) == expected.is_repeat(1));
+            REQUIRE(pos.repeat_count() == expected.repeat_count());
+            for (int ply = 1; ply <= 8; ++ply) {
+                REQUIRE(pos.has_game_cycle(ply) == expected.has_game_cycle(ply));
+            }
+        }
+    }
+    REQUIRE(pos.is_repeat(1));
+    REQUIRE(pos.repeat_count() == 2);
+    while (!moves.empty()) {
+        pos.unmake_move(moves.back(), undo_stack[moves.size() - 1]);
+        moves.pop_back();
+    }
+    REQUIRE(pos.hash() == Position{STARTPOS_FEN}.hash());
+    check_check_info(pos);
+}
+
+TEST_CASE("Material Key and PSQT Test", "[Position]") {
+    Position pos{STARTPOS_FEN};
+    check_material(pos);
+    REQUIRE(pos.psqt_mg(WHITE) == 0);
+    REQUIRE(pos.piece_count(PAWN, BLACK) == 8);
+    REQUIRE(pos.piece_count(QUEEN, WHITE) == 1);
+
+    // Only the material counts towards the key
+    Position moved{"rnbqkbnr/pppppppp/8/8/4P3/8/PPPP1PPP/RNBQKBNR b KQkq - 0 1"};
+    REQUIRE(moved.material_key() == pos.material_key());
+    Position fewer{"rnbqkbnr/pppppppp/8/8/8/8/PPPP1PPP/RNBQKBNR w KQkq - 0 1"};
+    REQUIRE(fewer.material_key() != pos.material_key());
+
+    // The table is color-relative, so the start position sums are the same for both sides
+    PSQT psqt = make_test_psqt();
+    pos.set_psqt(&psqt);
+    check_material(pos);
+    REQUIRE(pos.psqt_mg(WHITE) == pos.psqt_mg(BLACK));
+    REQUIRE(pos.psqt_eg(WHITE) == pos.psqt_eg(BLACK));
+
+    Position flipped{"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1"};
+    flipped.set_psqt(&psqt);
+    int white_mg = flipped.psqt_mg(WHITE);
+    flipped.vflip();
+    check_material(flipped);
+    REQUIRE(flipped.psqt_mg(BLACK) == white_mg);
+
+    pos.set_psqt(nullptr);
+    check_material(pos);
+    REQUIRE(pos.psqt_eg(BLACK) == 0);
+}
+
 TEST_CASE("Repetition Test", "[Position]") {
     Position pos{STARTPOS_FEN};
 
@@ -125,6 +478,7 @@ TEST_CASE("Flip Test", "[Position]") {
 
     pos.vflip();
     REQUIRE(pos.fen() == "rnbqkbn1/pppppppp/8/8/7P/8/PPPPPPP1/RNBQKBNR b KQq h3 0 1");
+    REQUIRE(pos.piece_on(H4) == Piece{PAWN, WHITE});
 
     pos.vflip();
     REQUIRE(pos.fen() == "rnbqkbnr/ppppppp1/8/7p/8/8/PPPPPPPP/RNBQKBN1 w Qkq h6 0 1");
@@ -142,6 +496,41 @@ TEST_CASE("UCI Position Line Test", "[Position]") {
     REQUIRE(pos->fen() == expected_fen);
     REQUIRE(pos->start_fen() == fen);
     REQUIRE(pos->uci_line() == line);
+
+    // A game longer than MAX_PLY still leaves MAX_PLY moves of room for a search
+    std::string shuffle;
+    for (int i = 0; i < Position::MAX_PLY; ++i) {
+        shuffle += " g1f3 g8f6 f3g1 f6g8";
+    }
+    pos = Position::from_uci_position_line("position " + fen + " moves" + shuffle);
+    REQUIRE(pos);
+    for (int i = 0; i < Position::MAX_PLY / 4; ++i) {
+        for (Move move : {Move{G1, F3}, Move{G8, F6}, Move{F3, G1}, Move{F6, G8}}) {
+            pos->make_move(move);
+        }
+    }
+    REQUIRE(pos->hash() == Position{fen}.hash());
+}
+
+TEST_CASE("History Growth Test", "[Position]") {
+    // Without reserve_history() the history grows past MAX_PLY on its own
+    Position pos{STARTPOS_FEN};
+    Position::hash_type start_hash = pos.hash();
+    int plies = 0;
+    for (int i = 0; i < Position::MAX_PLY; ++i) {
+        for (Move move : {Move{G1, F3}, Move{G8, F6}, Move{F3, G1}, Move{F6, G8}}) {
+            pos.make_move(move);
+            ++plies;
+        }
+    }
+    pos.make_null_move();
+    REQUIRE(pos.hash() == (start_hash ^ zobrist::side_to_move_key()));
+    pos.unmake_move();
+    for (int i = 0; i < plies; ++i) {
+        pos.unmake_move();
+    }
+    REQUIRE(pos.hash() == start_hash);
+    REQUIRE(pos.fullmoves() == 1);
 }
 
 TEST_CASE("Smallest Capture Move Test Pawn", "[Position]") {
@@ -437,3 +826,174 @@ TEST_CASE("Fivefold Repetition Legal Movegen Test", "[Position]") {
     REQUIRE(pos.repeat_count() == 4);
     REQUIRE(pos.legal_move_list().empty());
 }
+
+TEST_CASE("Maximum Legal Moves Test", "[Position]") {
+    // 218 legal moves, the most any position has
+    Position pos{"R6R/3Q4/1Q4Q1/4Q3/2Q4Q/Q4Q2/pp1Q4/kBNN1KB1 w - - 0 1"};
+    REQUIRE(pos.legal_move_list().size() == 218);
+}
+
+TEST_CASE("Legal Move Count Test", "[Position]") {
+    // pins, checks, enpassant, castling and promotions from both sides
+    for (const std::string fen : {
+             "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+             "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+             "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+             "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+         }) {
+        Position pos{fen};
+        check_legal_move_count(pos, 2);
+    }
+}
+
+TEST_CASE("SEE Move Test X-Ray", "[Position]") {
+    // The rook on e1 recaptures through the rook on e2 once it has moved
+    Position pos{"4r2k/8/8/4p3/8/8/4R3/K3R3 w - - 0 1"};
+    REQUIRE(pos.see_for(Move{E2, E5}, {100, 300, 300, 500, 900, 0}) == 100);
+}
+
+TEST_CASE("SEE Threshold Test", "[Position]") {
+    Position pos{"4r2k/8/8/4p3/8/8/4R3/K3R3 w - - 0 1"};
+    REQUIRE(pos.see_ge(Move{E2, E5}, 100));
+    REQUIRE(!pos.see_ge(Move{E2, E5}, 101));
+
+    pos = Position{"4r2k/8/8/4p3/8/8/4R3/K7 w - - 0 1"};
+    REQUIRE(pos.see_ge(Move{E2, E5}, -400));
+    REQUIRE(!pos.see_ge(Move{E2, E5}, -399));
+    REQUIRE(pos.see_ge(Move{A1, B1}, 0));
+    REQUIRE(!pos.see_ge(Move{A1, B1}, 1));
+
+    // Rxh3 would only lose the rook to the queen behind the pawn
+    pos = Position{"rnb2knr/p2qppbp/1p6/8/P1p1P1pP/2N2PP1/1PPP4/R1BQK1NR w KQ - 0 10"};
+    REQUIRE(pos.see_ge(Move{G1, H3}, -300));
+    REQUIRE(!pos.see_ge(Move{G1, H3}, -299));
+
+    // The recapture promotes
+    pos = Position{"1r4k1/p1pPp3/b2r4/1P5p/B3p2P/P3nN2/1RP4b/4K2R b - - 2 36"};
+    REQUIRE(pos.see_ge(Move{B8, E8}, -1300));
+    REQUIRE(!pos.see_ge(Move{B8, E8}, -1299));
+}
+
+TEST_CASE("Templated Move Generation Test", "[Position]") {
+    // pins, checks, discovered checks, enpassant, castling and promotions from both sides
+    for (const std::string fen : {
+             "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+             "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+             "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+             "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+             "n1n5/PPPk4/8/8/8/8/4Kppp/5N1N b - - 0 1",
+             "4k3/8/2P5/4N3/B7/8/4R3/R3K3 w Q - 0 1",
+             "B6b/8/8/8/2K5/5k2/8/b6B b - - 0 1",
+         }) {
+        Position pos{fen};
+        check_generate(pos, 2);
+    }
+}
+
+TEST_CASE("Gives Check Test", "[Position]") {
+    // enpassant clearing both pawns off the rook's rank
+    Position pos{"8/8/8/k1pP3R/8/8/8/4K3 w - c6 0 1"};
+    REQUIRE(pos.gives_check(Move{D5, C6, Move::Type::ENPASSANT}));
+    REQUIRE(!pos.gives_check(Move{D5, D6}));
+    // castling with the rook landing on the king's file
+    pos = Position{"5k2/8/8/8/8/8/8/4K2R w K - 0 1"};
+    REQUIRE(pos.gives_check(Move{E1, G1, Move::Type::CASTLING}));
+    // only the knight promotion checks
+    pos = Position{"8/1P1k4/8/8/8/8/8/4K3 w - - 0 1"};
+    REQUIRE(pos.gives_check(Move{B7, B8, KNIGHT, Move::Type::PROMOTION}));
+    REQUIRE(!pos.gives_check(Move{B7, B8, QUEEN, Move::Type::PROMOTION}));
+    MoveList quiet_checks;
+    pos.generate<Position::GenType::QUIET_CHECKS>(quiet_checks);
+    REQUIRE(quiet_checks.contains(Move{B7, B8, KNIGHT, Move::Type::PROMOTION}));
+}
+
+TEST_CASE("Legal Move Validation Test", "[Position]") {
+    // pins, single and double checks, enpassant, castling and promotions from both sides
+    for (const std::string fen : {
+             "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+             "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+             "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+             "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+             "n1n5/PPPk4/8/8/8/8/4Kppp/5N1N b - - 0 1",
+             "B6b/8/8/8/2K5/5k2/8/b6B b - - 0 1",
+             "r3k2r/8/8/8/8/8/8/R3K2R w KQkq - 0 1",
+         }) {
+        Position pos{fen};
+        check_is_legal_move(pos, 2);
+    }
+}
+
+TEST_CASE("Game Cycle Test", "[Position]") {
+    REQUIRE(cuckoo::CUCKOO_TABLE.size() == cuckoo::CuckooTable::MOVE_COUNT);
+
+    Position pos{STARTPOS_FEN};
+    for (auto move_str : {"g1f3", "g8f6", "f3g1"}) {
+        REQUIRE(!pos.has_game_cycle(8));
+        pos.make_move(*Move::from(move_str));
+    }
+    // f6g8 returns to the start position, which only counts at once within the search
+    REQUIRE(pos.has_game_cycle(4));
+    REQUIRE(!pos.has_game_cycle(0));
+    for (auto move_str : {"f6g8", "g1f3", "g8f6", "f3g1"}) {
+        pos.make_move(*Move::from(move_str));
+    }
+    REQUIRE(pos.has_game_cycle(0));
+
+    // A pawn move resets the window
+    pos.make_move(*Move::from("e7e5"));
+    REQUIRE(!pos.has_game_cycle(8));
+}
+
+TEST_CASE("Game Cycle Random Walk Test", "[Position]") {
+    // Every legal move into an earlier position is seen by the cuckoo probe
+    std::mt19937 rng{12345};
+    for (const std::string fen : {
+             "8/8/3k4/8/8/3K4/8/R7 w - - 0 1",
+             "6k1/5pp1/8/8/8/8/1Q3PP1/6K1 w - - 0 1",
+             "4k3/8/1n6/8/8/5B2/8/4K3 w - - 0 1",
+         }) {
+        Position pos{fen};
+        for (int ply = 0; ply < 300; ++ply) {
+            MoveList move_list = pos.legal_move_list();
+            if (move_list.empty()) {
+                break;
+            }
+            bool repeats = false;
+            for (Move move : move_list) {
+                pos.make_move(move);
+                repeats = repeats || pos.is_repeat(1);
+                pos.unmake_move();
+            }
+            if (repeats) {
+                REQUIRE(pos.has_game_cycle(ply + 1));
+            }
+            pos.make_move(*(move_list.begin() + rng() % move_list.size()));
+        }
+    }
+}
+
+TEST_CASE("Has Legal Move Test", "[Position]") {
+    for (const std::string fen : {
+             // checkmates, including a double check and a smothered mate
+             "rnb1kbnr/pppp1ppp/8/4p3/6Pq/5P2/PPPPP2P/RNBQKBNR w KQkq - 1 3",
+             "6rk/5Npp/8/8/8/8/8/6K1 b - - 0 1",
+             "4k3/8/8/8/8/7n/5PPP/4r1K1 w - - 0 1",
+             // stalemates
+             "7k/5Q2/8/8/8/8/8/6K1 b - - 0 1",
+             "k7/P7/1K6/8/8/8/8/8 b - - 0 1",
+         }) {
+        Position pos{fen};
+        REQUIRE(!pos.has_legal_move());
+        REQUIRE(pos.legal_move_list().empty());
+        REQUIRE(pos.game_state() ==
+                (pos.in_check() ? Position::GameState::CHECKMATE : Position::GameState::STALEMATE));
+    }
+    // enpassant evasions and a pinned pawn capturing its pinner
+    for (const std::string fen : {
+             "8/8/8/2k5/3Pp3/8/8/4K2R b K d3 0 1",
+             "4k3/3p4/2B5/8/8/8/8/4K3 b - - 0 1",
+         }) {
+        Position pos{fen};
+        REQUIRE(pos.has_legal_move() == !pos.legal_move_list().empty());
+    }
+}
@@ -0,0 +1,151 @@
+#include <catch2/catch_all.hpp>
+
+#include <atomic>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "../Position.h"
+#include "../TranspositionTable.h"
+
+using namespace libchess;
+using namespace constants;
+
+TEST_CASE("Transposition Table Store Probe Test", "[TranspositionTable]") {
+    TranspositionTable tt{1};
+    REQUIRE(tt.size_bytes() == 1 << 20);
+
+    Position pos{STARTPOS_FEN};
+    REQUIRE(!tt.probe(pos.hash()));
+
+    Move move{E2, E4};
+    tt.store(pos.hash(), move, -35, 7, TranspositionTable::Bound::LOWER);
+    auto entry = tt.probe(pos.hash());
+    REQUIRE(entry);
+    REQUIRE(entry->move == move);
+    REQUIRE(entry->score == -35);
+    REQUIRE(entry->depth == 7);
+    REQUIRE(entry->bound == TranspositionTable::Bound::LOWER);
+
+    // A null move keeps the stored move, and out of range values are clamped
+    tt.store(pos.hash(), Move{}, 40000, -200, TranspositionTable::Bound::EXACT);
+    entry = tt.probe(pos.hash());
+    REQUIRE(entry->move == move);
+    REQUIRE(entry->score == 32767);
+    REQUIRE(entry->depth == TranspositionTable::MIN_DEPTH);
+
+    tt.store(pos.hash_after(move), Move{}, 0, 0, TranspositionTable::Bound::UPPER);
+    pos.make_move(move);
+    tt.prefetch(pos.hash());
+    REQUIRE(tt.probe(pos.hash()));
+    REQUIRE(!tt.probe(pos.hash())->move);
+
+    tt.clear(4);
+    REQUIRE(!tt.probe(pos.hash()));
+
+    // Resizing zeroes the new table from several threads
+    tt.resize(8, 3);
+    REQUIRE(tt.size_bytes() == 8 << 20);
+    REQUIRE(tt.hashfull() == 0);
+    REQUIRE(!tt.probe(pos.hash()));
+    tt.store(pos.hash(), move, 1, 1, TranspositionTable::Bound::UPPER);
+    REQUIRE(tt.probe(pos.hash())->move == move);
+}
+
+TEST_CASE("Transposition Table Replacement Test", "[TranspositionTable]") {
+    // A single cluster, so every hash competes for the same eight entries
+    TranspositionTable tt{0};
+    for (int i = 0; i < 8; ++i) {
+        tt.store(i + 1, Move{}, 0, 10 + i, TranspositionTable::Bound::EXACT);
+    }
+    // The shallowest entry goes first
+    tt.store(100, Move{}, 0, 20, TranspositionTable::Bound::EXACT);
+    REQUIRE(!tt.probe(1));
+    REQUIRE(tt.probe(100));
+
+    // Then entries of older searches, even deep ones
+    tt.new_search();
+    tt.store(200, Move{}, 0, 5, TranspositionTable::Bound::EXACT);
+    tt.store(300, Move{}, 0, 5, TranspositionTable::Bound::EXACT);
+    REQUIRE(tt.probe(200));
+    REQUIRE(tt.probe(300));
+    REQUIRE(!tt.probe(2));
+    REQUIRE(!tt.probe(3));
+    REQUIRE(tt.probe(100));
+
+    // A much shallower store of the same position only updates the move
+    tt.store(200, Move{E2, E4}, 10, 20, TranspositionTable::Bound::LOWER);
+    tt.store(200, Move{D2, D4}, 20, 16, TranspositionTable::Bound::UPPER);
+    auto entry = tt.probe(200);
+    REQUIRE(entry->move == Move{D2, D4});
+    REQUIRE(entry->score == 10);
+    REQUIRE(entry->depth == 20);
+    REQUIRE(entry->bound == TranspositionTable::Bound::LOWER);
+    // One close to the stored depth replaces it, as does an exact one or one of a later search
+    tt.store(200, Move{}, 30, 17, TranspositionTable::Bound::UPPER);
+    REQUIRE(tt.probe(200)->depth == 17);
+    REQUIRE(tt.probe(200)->move == Move{D2, D4});
+    tt.store(200, Move{}, 40, 1, TranspositionTable::Bound::EXACT);
+    REQUIRE(tt.probe(200)->depth == 1);
+    tt.store(300, Move{}, 0, 30, TranspositionTable::Bound::LOWER);
+    tt.new_search();
+    tt.store(300, Move{}, 50, 2, TranspositionTable::Bound::UPPER);
+    REQUIRE(tt.probe(300)->depth == 2);
+}
+
+TEST_CASE("Transposition Table Hashfull Test", "[TranspositionTable]") {
+    TranspositionTable tt{1};
+    REQUIRE(tt.hashfull() == 0);
+    std::mt19937_64 rng{1};
+    for (int i = 0; i < 200000; ++i) {
+        tt.store(rng(), Move{}, 0, 1, TranspositionTable::Bound::EXACT);
+    }
+    REQUIRE(tt.hashfull() > 800);
+    tt.new_search();
+    REQUIRE(tt.hashfull() == 0);
+    tt.clear();
+    REQUIRE(tt.hashfull() == 0);
+}
+
+TEST_CASE("Transposition Table Concurrency Test", "[TranspositionTable]") {
+    // The depth of every stored entry is derived from its score, so a torn entry would show up
+    // as a mismatch, whichever position's entry a key collision returns
+    TranspositionTable tt{1};
+    std::vector<std::thread> threads;
+    std::atomic<int> mismatches{0};
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&tt, &mismatches, t] {
+            std::mt19937_64 rng{std::uint64_t(t % 2)};
+            for (int i = 0; i < 100000; ++i) {
+                std::uint64_t hash = rng();
+                int score = std::int16_t(hash >> 48);
+                tt.store(hash, Move{}, score, score & 0x7f, TranspositionTable::Bound::EXACT);
+                auto entry = tt.probe(hash);
+                if (entry && entry->depth != (entry->score & 0x7f)) {
+                    ++mismatches;
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    REQUIRE(mismatches == 0);
+}
+
+TEST_CASE("Multiply High Test", "[TranspositionTable]") {
+    using intrinsics::mul_hi64;
+    using intrinsics::mul_hi64_portable;
+    constexpr std::uint64_t MAX = ~std::uint64_t(0);
+    REQUIRE(mul_hi64_portable(0, MAX) == 0);
+    REQUIRE(mul_hi64_portable(MAX, MAX) == MAX - 1);
+    REQUIRE(mul_hi64_portable(std::uint64_t(1) << 32, std::uint64_t(1) << 32) == 1);
+    REQUIRE(mul_hi64_portable(MAX, 3) == 2);
+    std::mt19937_64 rng{0};
+    for (int i = 0; i < 10000; ++i) {
+        std::uint64_t a = rng();
+        std::uint64_t b = i % 2 ? rng() : rng() >> 40;
+        REQUIRE(mul_hi64(a, b) == mul_hi64_portable(a, b));
+        REQUIRE(mul_hi64(a, b) < std::max<std::uint64_t>(b, 1));
+    }
+}